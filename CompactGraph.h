@@ -0,0 +1,242 @@
+#ifndef COMPACTGRAPH_H
+#define COMPACTGRAPH_H
+
+#include <deque>
+#include <vector>
+#include <limits>
+#include <cstdint>
+
+#include "GraphSnapshot.h"
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* A standalone graph with a compact memory layout for very large networks.
+* There are no node and edge objects: nodes and edges are numbered from 0, and the adjacency
+* is stored as one array of 32-bit node indices and weights, plus a 32-bit edge id per arc.
+* With float weights, an edge needs 12 bytes and a node 4 bytes, so a billion edges fit into
+* 12 GB. A Graph with SimpleEdges needs about 100 bytes per edge instead.
+* The graph is immutable, so any number of threads can query it at the same time.
+* @tparam W the type of the weights, e.g. float or double.
+*/
+template<class W = float>
+class CompactGraph
+{
+
+public:
+
+    //! @Datataypes
+
+    typedef std::uint32_t tIndex;
+    typedef W tWeight;
+
+    /** An edge from node src to node dst. Its id is its position in the edge list. */
+    struct tEdge
+    {
+        tIndex src;
+        tIndex dst;
+        tWeight weight;
+    };
+
+    typedef std::vector<tEdge> tEdges;
+
+    /** The ids of the edges of a path. */
+    typedef std::deque<tIndex> tPath;
+
+
+public:
+
+    //! @Lifetime
+
+    /**
+    * Builds the adjacency from an edge list, which is not needed afterwards.
+    * @param numNodes the nodes are 0 .. numNodes - 1.
+    * @throw Graph::InvalidNodeException if an edge refers to a node >= numNodes.
+    * @throw Graph::Exception if there are 2^32 or more nodes or edges.
+    */
+    CompactGraph(size_t numNodes, const tEdges& edges);
+
+    /**
+    * Copies a snapshot, which can be released afterwards together with its graph.
+    * Node i is the node rSnapshot.getNodes()[i], edge i is the i-th arc of the snapshot,
+    * when the outgoing edges of the nodes are enumerated in this order.
+    */
+    explicit CompactGraph(const GraphSnapshot& rSnapshot);
+
+
+    //! @Graph Information
+
+    size_t getNumNodes() const { return m_firstArc.size() - 1; }
+
+    size_t getNumEdges() const { return m_arcs.size(); }
+
+    /** The memory of the graph in bytes. */
+    size_t getMemoryUsage() const;
+
+
+    //! @Routing
+
+    /**
+    * Calculate the shortest path from a source node to a destination node.
+    * @return the ids of the edges from src to dst. It is empty, if there is no path.
+    * @throw Graph::InvalidNodeException if a node does not exist.
+    */
+    tPath findShortestPathDijkstra(size_t src, size_t dst) const;
+
+    /** Calculate the shortest path like above, but reuse the memory of the given workspace. */
+    tPath findShortestPathDijkstra(size_t src, size_t dst, GraphSnapshot::Workspace& rWorkspace) const;
+
+
+private:
+
+    // an outgoing edge in the adjacency array
+    struct tArc
+    {
+        tIndex dst;
+        tWeight weight;
+    };
+
+    // the outgoing arcs of node i are m_arcs[m_firstArc[i]] .. m_arcs[m_firstArc[i + 1] - 1]
+    std::vector<tIndex> m_firstArc;
+    std::vector<tArc> m_arcs;
+
+    // the edge id of each arc
+    std::vector<tIndex> m_arcEdges;
+
+#ifdef TESTING
+    friend class GraphTesting;
+#endif
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+template<class W>
+CompactGraph<W>::CompactGraph(size_t numNodes, const tEdges& edges)
+{
+    // the largest index is reserved, so that the number of nodes and edges fits, too
+    const size_t maxIndex = std::numeric_limits<tIndex>::max();
+    if (numNodes >= maxIndex || edges.size() >= maxIndex) {
+        throw Graph::Exception("too many nodes or edges for a compact graph");
+    }
+
+    // count the outgoing edges of each node, then place them by their source
+    m_firstArc.assign(numNodes + 1, 0);
+    for (const tEdge& rEdge : edges) {
+        if (rEdge.src >= numNodes || rEdge.dst >= numNodes) {
+            throw Graph::InvalidNodeException("edge refers to a node that does not exist");
+        }
+        m_firstArc[rEdge.src + 1] += 1;
+    }
+    for (size_t u = 0; u < numNodes; u++) m_firstArc[u + 1] += m_firstArc[u];
+
+    m_arcs.resize(edges.size());
+    m_arcEdges.resize(edges.size());
+    std::vector<tIndex> next(m_firstArc.begin(), m_firstArc.end() - 1);
+    for (size_t e = 0; e < edges.size(); e++) {
+        tIndex a = next[edges[e].src]++;
+        m_arcs[a].dst = edges[e].dst;
+        m_arcs[a].weight = edges[e].weight;
+        m_arcEdges[a] = tIndex(e);
+    }
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+template<class W>
+CompactGraph<W>::CompactGraph(const GraphSnapshot& rSnapshot)
+{
+    const size_t maxIndex = std::numeric_limits<tIndex>::max();
+    if (rSnapshot.m_arcs.size() >= maxIndex) {
+        throw Graph::Exception("too many edges for a compact graph");
+    }
+
+    m_firstArc.assign(rSnapshot.m_firstArc.begin(), rSnapshot.m_firstArc.end());
+    m_arcs.resize(rSnapshot.m_arcs.size());
+    m_arcEdges.resize(rSnapshot.m_arcs.size());
+    for (size_t a = 0; a < m_arcs.size(); a++) {
+        m_arcs[a].dst = rSnapshot.m_arcs[a].dst;
+        m_arcs[a].weight = tWeight(rSnapshot.m_arcs[a].weight);
+        m_arcEdges[a] = tIndex(a);
+    }
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+template<class W>
+size_t CompactGraph<W>::getMemoryUsage() const
+{
+    return sizeof(CompactGraph)
+        + m_firstArc.capacity() * sizeof(tIndex)
+        + m_arcs.capacity() * sizeof(tArc)
+        + m_arcEdges.capacity() * sizeof(tIndex);
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+template<class W>
+typename CompactGraph<W>::tPath CompactGraph<W>::findShortestPathDijkstra(size_t src, size_t dst) const
+{
+    GraphSnapshot::Workspace workspace;
+    return findShortestPathDijkstra(src, dst, workspace);
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+template<class W>
+typename CompactGraph<W>::tPath CompactGraph<W>::findShortestPathDijkstra(size_t src, size_t dst,
+        GraphSnapshot::Workspace& rWorkspace) const
+{
+    size_t numNodes = getNumNodes();
+    if (src >= numNodes || dst >= numNodes) {
+        throw Graph::InvalidNodeException("node does not exist in the compact graph");
+    }
+
+    // the distances are summed up in double precision, also for float weights
+    GraphSnapshot::Workspace& w = rWorkspace;
+    w.reset(numNodes);
+    w.update(src, 0, numNodes, 0);
+    w.push(0, src);
+
+    while (!w.m_queue.empty()) {
+        GraphSnapshot::Workspace::tQueueEntry top = w.pop();
+
+        size_t u = top.second;
+        // skip outdated queue entries
+        if (top.first > w.m_distance[u]) {
+            continue;
+        }
+
+        if (u == dst) {
+            break;
+        }
+
+        for (size_t a = m_firstArc[u]; a < m_firstArc[u + 1]; a++) {
+            double newDistance = w.m_distance[u] + m_arcs[a].weight;
+            if (newDistance < w.getDistance(m_arcs[a].dst)) {
+                w.update(m_arcs[a].dst, newDistance, u, a);
+                w.push(newDistance, m_arcs[a].dst);
+            }
+        }
+    }
+
+    // insert the path to a deque, it stays empty if no path was found
+    tPath path;
+    if (w.isReached(dst)) {
+        for (size_t current = dst; w.m_prevNode[current] != numNodes; current = w.m_prevNode[current]) {
+            path.push_front(m_arcEdges[w.m_prevArc[current]]);
+        }
+    }
+
+    return path;
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
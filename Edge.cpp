@@ -1,10 +1,12 @@
 #include "Edge.h"
 
+#include <algorithm>
+
 
 //-------------------------------------------------------------------------------------------------
 
 Edge::Edge(Node& rSrc, Node& rDst) 
-    : m_srcNode(rSrc), m_dstNode(rDst)  
+    : m_srcNode(rSrc), m_dstNode(rDst), m_isAttached(true)
 {  
     rSrc.getOutEdges().push_back(this);
     rDst.getInEdges().push_back(this);
@@ -15,8 +17,21 @@ Edge::Edge(Node& rSrc, Node& rDst)
 
 Edge::~Edge()
 {
-    m_srcNode.getOutEdges().remove(this);
-    m_dstNode.getInEdges().remove(this);
+    detach();
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void Edge::detach()
+{
+    if (m_isAttached) {
+        Node::tEdgePtrs& rOutEdges = m_srcNode.getOutEdges();
+        rOutEdges.erase(std::remove(rOutEdges.begin(), rOutEdges.end(), this), rOutEdges.end());
+        Node::tEdgePtrs& rInEdges = m_dstNode.getInEdges();
+        rInEdges.erase(std::remove(rInEdges.begin(), rInEdges.end(), this), rInEdges.end());
+        m_isAttached = false;
+    }
 }
 
 
@@ -32,6 +32,16 @@ public:
     /** Override this function in order to retrieve the correct weight. */
     virtual double getWeight() const = 0;
 
+    /**
+    * Removes this edge from the edge lists of its source and destination node.
+    * The graph detaches removed edges before it retires them, so that a deferred
+    * destruction does not touch the nodes anymore.
+    */
+    void detach();
+
+    /** The memory of this edge in bytes. Override this function in derived classes. */
+    virtual size_t getMemoryUsage() const { return sizeof(Edge); }
+
 	Node& getSrcNode() { return m_srcNode; }
 	Node& getDstNode() { return m_dstNode; }
 
@@ -41,6 +51,8 @@ private:
 	Node& m_srcNode;
 	Node& m_dstNode;
 
+    bool m_isAttached;
+
 #ifdef TESTING
     friend class GraphTesting;
 #endif
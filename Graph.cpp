@@ -1,7 +1,45 @@
 ﻿#include "Graph.h"
+#include "GraphSnapshot.h"
+#include "UnionFind.h"
+#include "NodeIndex.h"
+#include "Parallel.h"
 
 #include <map>
 #include <limits>
+#include <atomic>
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tRetiredObjects::~tRetiredObjects()
+{
+    // edges are detached already, so the order of destruction does not matter
+    for (Edge* pEdge : edges) delete pEdge;
+    for (Node* pNode : nodes) delete pNode;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+/**
+* Numbers the nodes by their position in the given order and retrieves the node numbers of the
+* source and destination of all edges in parallel.
+*/
+static void getEndpoints(const std::vector<Node*>& nodes, const std::vector<Edge*>& edges,
+        size_t numThreads, std::vector<UnionFind::tIndex>& rSrc, std::vector<UnionFind::tIndex>& rDst)
+{
+    NodeIndex index(nodes.begin(), nodes.end());
+    auto getIndex = [&](const Node& rNode) { return index.getIndex(rNode); };
+
+    rSrc.resize(edges.size());
+    rDst.resize(edges.size());
+    parallelFor(numThreads, edges.size(), [&](size_t, size_t begin, size_t end) {
+        for (size_t e = begin; e < end; e++) {
+            rSrc[e] = getIndex(edges[e]->getSrcNode());
+            rDst[e] = getIndex(edges[e]->getDstNode());
+        }
+    });
+}
 
 
 //-------------------------------------------------------------------------------------------------
@@ -20,7 +58,7 @@ bool Graph::remove(const Edge& rEdge)
 {
     auto it = std::find(m_edges.begin(), m_edges.end(), &rEdge);
     if (it != m_edges.end()) {
-        delete *it;
+        retire(*it);
         m_edges.erase(it);
         return true;
     }
@@ -35,19 +73,19 @@ bool Graph::remove(const Node& rNode)
 {
     auto it = std::find(m_nodes.begin(), m_nodes.end(), &rNode);
     if (it != m_nodes.end()) {
-        // delete all edges that are connected with the given node
-        auto eIt = m_edges.begin();
-        while (eIt != m_edges.end()) {
-            if ((*eIt)->isConnectedTo(rNode)) {
-                delete *eIt;
-                eIt = m_edges.erase(eIt);
+        // delete all edges that are connected with the given node, keep the others in order
+        size_t numKept = 0;
+        for (Edge* pEdge : m_edges) {
+            if (pEdge->isConnectedTo(rNode)) {
+                retire(pEdge);
             }
             else {
-                eIt++;
+                m_edges[numKept++] = pEdge;
             }
         }
+        m_edges.resize(numKept);
         // delete the node
-        delete *it;
+        retire(*it);
         m_nodes.erase(it);
         return true;
     }
@@ -232,4 +270,243 @@ Graph::tPath Graph::findShortestPathDijkstra(const Node& rSrc, const Node& rDst)
 }
 
 
+//-------------------------------------------------------------------------------------------------
+
+/**
+* In each round of Boruvka's algorithm, every component selects its lightest edge to another
+* component, and all selected edges are added to the forest. This at least halves the number
+* of components per round. The selection uses an atomic minimum per component, the merging
+* a lock-free union-find, so the threads never wait for each other within a round.
+*/
+Graph::tEdges Graph::findMinimumSpanningForest(size_t numThreads) const
+{
+    numThreads = std::max<size_t>(1, numThreads);
+
+    tNodes nodes(m_nodes.begin(), m_nodes.end());
+    std::vector<UnionFind::tIndex> src, dst;
+    getEndpoints(nodes, m_edges, numThreads, src, dst);
+
+    std::vector<double> weights(m_edges.size());
+    parallelFor(numThreads, m_edges.size(), [&](size_t, size_t begin, size_t end) {
+        for (size_t e = begin; e < end; e++) weights[e] = m_edges[e]->getWeight();
+    });
+
+    // a strict order of the edges ensures, that the selected edges never form a cycle
+    auto isLighter = [&](size_t a, size_t b) {
+        return weights[a] < weights[b] || (weights[a] == weights[b] && a < b);
+    };
+
+    const size_t none = std::numeric_limits<size_t>::max();
+    std::vector<std::atomic<size_t>> lightestEdge(nodes.size());
+    for (std::atomic<size_t>& rEdge : lightestEdge) rEdge.store(none, std::memory_order_relaxed);
+
+    UnionFind components(nodes.size());
+    std::vector<tIndices> forestOfThread(numThreads);
+    std::vector<tIndices> activeOfThread(numThreads);
+
+    // the edges, that may still connect two components
+    tIndices active(m_edges.size());
+    for (size_t e = 0; e < active.size(); e++) active[e] = e;
+
+    while (!active.empty()) {
+        // each component selects its lightest outgoing edge
+        parallelFor(numThreads, active.size(), [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                size_t e = active[i];
+                size_t rootSrc = components.find(src[e]);
+                size_t rootDst = components.find(dst[e]);
+                if (rootSrc == rootDst) continue;
+
+                for (size_t root : { rootSrc, rootDst }) {
+                    size_t lightest = lightestEdge[root].load();
+                    while ((lightest == none || isLighter(e, lightest))
+                           && !lightestEdge[root].compare_exchange_weak(lightest, e)) {
+                    }
+                }
+            }
+        });
+
+        // add the selected edges. An edge selected by both of its components is added once.
+        parallelFor(numThreads, nodes.size(), [&](size_t t, size_t begin, size_t end) {
+            for (size_t v = begin; v < end; v++) {
+                size_t e = lightestEdge[v].load();
+                if (e == none) continue;
+
+                lightestEdge[v].store(none);
+                if (components.unite(src[e], dst[e])) {
+                    forestOfThread[t].push_back(e);
+                }
+            }
+        });
+
+        // drop the edges within a component. parallelFor may use fewer threads than there are
+        // slots, so all of them are cleared here, not by the threads.
+        for (tIndices& rActive : activeOfThread) rActive.clear();
+        parallelFor(numThreads, active.size(), [&](size_t t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                size_t e = active[i];
+                if (components.find(src[e]) != components.find(dst[e])) {
+                    activeOfThread[t].push_back(e);
+                }
+            }
+        });
+
+        active.clear();
+        for (const tIndices& rActive : activeOfThread) {
+            active.insert(active.end(), rActive.begin(), rActive.end());
+        }
+    }
+
+    tIndices forest;
+    for (const tIndices& rForest : forestOfThread) {
+        forest.insert(forest.end(), rForest.begin(), rForest.end());
+    }
+    std::sort(forest.begin(), forest.end());
+
+    tEdges result;
+    result.reserve(forest.size());
+    for (size_t e : forest) result.push_back(m_edges[e]);
+    return result;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tComponents Graph::findConnectedComponents(size_t numThreads) const
+{
+    numThreads = std::max<size_t>(1, numThreads);
+
+    tNodes nodes(m_nodes.begin(), m_nodes.end());
+    std::vector<UnionFind::tIndex> src, dst;
+    getEndpoints(nodes, m_edges, numThreads, src, dst);
+
+    UnionFind sets(nodes.size());
+    parallelFor(numThreads, m_edges.size(), [&](size_t, size_t begin, size_t end) {
+        for (size_t e = begin; e < end; e++) sets.unite(src[e], dst[e]);
+    });
+
+    // all threads are done, so the representatives are stable now
+    tIndices root(nodes.size());
+    parallelFor(numThreads, nodes.size(), [&](size_t, size_t begin, size_t end) {
+        for (size_t v = begin; v < end; v++) root[v] = sets.find(v);
+    });
+
+    // number the components in the order of their first node
+    const size_t none = std::numeric_limits<size_t>::max();
+    tIndices componentOf(nodes.size(), none);
+    tComponents components;
+    for (size_t v = 0; v < nodes.size(); v++) {
+        if (componentOf[root[v]] == none) {
+            componentOf[root[v]] = components.size();
+            components.push_back(tNodes());
+        }
+        components[componentOf[root[v]]].push_back(nodes[v]);
+    }
+
+    return components;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+std::shared_ptr<const GraphSnapshot> Graph::publishSnapshot(NodeOrder order)
+{
+    // objects retired from now on are still visible in the new snapshot. If nothing was
+    // retired since the last publish, both snapshots share the list, so the chain does not grow.
+    if (m_retired.empty() || !m_retired.back()->edges.empty() || !m_retired.back()->nodes.empty()) {
+        m_retired.push_back(std::unique_ptr<tRetiredObjects>(new tRetiredObjects()));
+    }
+
+    m_epoch += 1;
+    std::shared_ptr<const GraphSnapshot> pSnapshot(new GraphSnapshot(*this, order, m_epoch, *m_retired.back()));
+    std::atomic_store(&m_pSnapshot, pSnapshot);
+
+    // the previous snapshot may have been released just now
+    reclaim();
+
+    return pSnapshot;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+std::shared_ptr<const GraphSnapshot> Graph::getSnapshot() const
+{
+    return std::atomic_load(&m_pSnapshot);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tMemoryUsage Graph::getMemoryUsage() const
+{
+    tMemoryUsage usage = tMemoryUsage();
+
+    usage.adjacency = m_edges.capacity() * sizeof(Edge*);
+    for (Node* pNode : m_nodes) {
+        usage.nodes += pNode->getMemoryUsage();
+        usage.adjacency += (pNode->getOutEdges().capacity() + pNode->getInEdges().capacity()) * sizeof(Edge*);
+    }
+    for (Edge* pEdge : m_edges) {
+        usage.edges += pEdge->getMemoryUsage();
+    }
+
+    // a node of a red-black tree has three pointers and the color besides the value
+    usage.index = m_nodes.size() * (sizeof(Node*) + 4 * sizeof(void*));
+
+    std::shared_ptr<const GraphSnapshot> pSnapshot = getSnapshot();
+    if (pSnapshot) {
+        usage.snapshot = pSnapshot->getMemoryUsage();
+    }
+
+    // all lists, also the ones that are only kept for old snapshots. Only the writer changes them.
+    for (const std::unique_ptr<tRetiredObjects>& pRetired : m_retired) {
+        for (Edge* pEdge : pRetired->edges) usage.retired += pEdge->getMemoryUsage();
+        for (Node* pNode : pRetired->nodes) usage.retired += pNode->getMemoryUsage();
+    }
+
+    return usage;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void Graph::retire(Edge* pEdge)
+{
+    if (!m_retired.empty()) {
+        pEdge->detach();
+        m_retired.back()->edges.push_back(pEdge);
+    }
+    else {
+        delete pEdge;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void Graph::retire(Node* pNode)
+{
+    if (!m_retired.empty()) {
+        m_retired.back()->nodes.push_back(pNode);
+    }
+    else {
+        delete pNode;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void Graph::reclaim()
+{
+    // a list is only used by its own snapshots and the ones of the lists before. Those are
+    // freed already, so the first lists are freed while they are unused. The acquire order
+    // pairs with the release of the snapshots. The newest list is kept for the next removals.
+    while (m_retired.size() > 1 && m_retired.front()->numSnapshots.load(std::memory_order_acquire) == 0) {
+        m_retired.pop_front();
+    }
+}
+
+
 //-------------------------------------------------------------------------------------------------
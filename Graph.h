@@ -9,10 +9,14 @@
 #include <map>
 #include <algorithm>
 #include <memory>
+#include <thread>
+#include <atomic>
 
 #include "Node.h"
 #include "Edge.h"
 
+class GraphSnapshot;
+
 
 /* --------------------------------------------------------------------------------------------- */
 
@@ -32,10 +36,11 @@ private:
 
     // some typedefs for containers that are used in this class
     typedef std::set<Node*, SortNodeByIdHelper> tNodePtrSet;
-    typedef std::list<Edge*> tEdgePtrList;
     typedef std::deque<Edge*> tPath;
     typedef std::vector<Edge*> tEdges;
     typedef std::vector<Node*> tNodes;
+    typedef std::vector<tNodes> tComponents;
+    typedef std::vector<size_t> tIndices;
 
     struct tDijkstraInfo
     {
@@ -46,6 +51,19 @@ private:
 
     typedef std::map<Node*, tDijkstraInfo> tDijkstraMap;
 
+    // Nodes and edges that were removed while snapshots may still refer to them. Only the
+    // snapshots published right before the removal are counted, the older ones are counted
+    // by the lists before. The graph frees a list, when it and all lists before are unused.
+    struct tRetiredObjects
+    {
+        tEdges edges;
+        tNodes nodes;
+        std::atomic<size_t> numSnapshots;
+
+        tRetiredObjects() : numSnapshots(0) { }
+        ~tRetiredObjects();
+    };
+
 
 public:
 
@@ -53,10 +71,29 @@ public:
     class NodeCreationException;
     class InvalidNodeException;
     class NotFoundException;
+    class AbortedException;
+
+    /** The memory layout of the nodes in a snapshot. See publishSnapshot(). */
+    enum NodeOrder { ORDER_ID, ORDER_BFS, ORDER_DFS, ORDER_RCM, ORDER_HILBERT };
+
+    /** The memory of a graph in bytes, broken down by component. See getMemoryUsage(). */
+    struct tMemoryUsage
+    {
+        size_t nodes;       // the node objects, see Node::getMemoryUsage()
+        size_t edges;       // the edge objects, see Edge::getMemoryUsage()
+        size_t adjacency;   // the edge lists of the graph and of the nodes
+        size_t index;       // the search tree of the nodes by id (estimated)
+        size_t snapshot;    // the current snapshot
+        size_t retired;     // removed nodes and edges, that wait for the release of snapshots
+
+        size_t getTotal() const { return nodes + edges + adjacency + index + snapshot + retired; }
+    };
 
 
 public:
 
+    Graph() : m_epoch(0) { }
+
     virtual ~Graph();   
 
     /**
@@ -142,11 +179,86 @@ public:
     */
     tPath findShortestPathDijkstra(const Node& rSrc, const Node& rDst);
 
+    /**
+    * Calculates a minimum spanning forest with Boruvka's algorithm in parallel. The direction of
+    * the edges is ignored, the weights are read by Edge::getWeight(). Edges of equal weight are
+    * ordered by their position in the graph, so the result is the same for any number of threads.
+    * @return the edges of the forest in the order of the graph's edges.
+    * @throw Graph::Exception if the graph has more than 2^32 - 1 nodes.
+    */
+    tEdges findMinimumSpanningForest(size_t numThreads = std::thread::hardware_concurrency()) const;
+
+    /**
+    * Calculates the weakly connected components in parallel with a lock-free union-find.
+    * @return the nodes of each component. The components and their nodes are ordered by node id.
+    * @throw Graph::Exception if the graph has more than 2^32 - 1 nodes.
+    */
+    tComponents findConnectedComponents(size_t numThreads = std::thread::hardware_concurrency()) const;
+
+    /**
+    * Builds an immutable snapshot of the current graph and publishes it for readers.
+    * The writer keeps modifying the graph itself, readers only query snapshots. Nodes and
+    * edges that are removed after publishing are kept alive until no snapshot refers to them,
+    * then the next call frees them.
+    * Only one thread may modify the graph and publish snapshots at a time.
+    * All snapshots must be released before the graph is destroyed.
+    * Each snapshot is a full copy of the adjacency and the weights, not a copy-on-write of the
+    * previous version: publishing costs O(E log V) time on the calling thread and every live
+    * snapshot needs its own O(V + E) memory. Nothing is shared, because the graph cannot see,
+    * when an Edge subclass changes its weight. So publish after batches of updates.
+    * @param order the layout of nodes and edges in the snapshot. Nodes that are neighbours in the
+    *        graph are stored close to each other by ORDER_BFS, ORDER_DFS, ORDER_RCM (reverse
+    *        Cuthill-McKee) and ORDER_HILBERT (Hilbert curve over Node::getCoordinates()). This
+    *        reduces cache misses of searches on large graphs. Lookups and path lengths do not
+    *        change, but among several shortest paths, another one may be returned.
+    * @return the new snapshot, which is also returned by getSnapshot() from now on.
+    */
+    std::shared_ptr<const GraphSnapshot> publishSnapshot(NodeOrder order = ORDER_ID);
+
+    /**
+    * Retrieves the most recently published snapshot. Can be called from any thread.
+    * @return the snapshot or an empty pointer, if publishSnapshot() was never called.
+    */
+    std::shared_ptr<const GraphSnapshot> getSnapshot() const;
+
+    /**
+    * Reports the memory of the graph for capacity planning. Unused capacity of the containers
+    * is included. Snapshots other than the current one are not included.
+    * Must be called from the thread that modifies the graph.
+    */
+    tMemoryUsage getMemoryUsage() const;
+
 
 protected:
 
     tNodePtrSet m_nodes;
-    tEdgePtrList m_edges;
+    tEdges m_edges;
+
+
+private:
+
+    /** @return true, if the given node object is part of this graph. Runs in O(log n). */
+    bool contains(Node& rNode) const {
+        auto it = m_nodes.find(&rNode);
+        return it != m_nodes.end() && *it == &rNode;
+    }
+
+    /** Destroys the edge or defers it until the published snapshots are released. */
+    void retire(Edge* pEdge);
+
+    /** Destroys the node or defers it until the published snapshots are released. */
+    void retire(Node* pNode);
+
+    /** Frees the retired objects, that no snapshot can refer to anymore. */
+    void reclaim();
+
+    // the retired objects from old to new. Only the writer changes the lists, snapshots just
+    // count themselves. Declared first, so the current snapshot is released before.
+    std::deque<std::unique_ptr<tRetiredObjects>> m_retired;
+    std::shared_ptr<const GraphSnapshot> m_pSnapshot;
+    unsigned long long m_epoch;
+
+    friend class GraphSnapshot;
 
 #ifdef TESTING
     friend class GraphTesting;
@@ -179,6 +291,10 @@ class Graph::NotFoundException : public Graph::Exception {
     public: NotFoundException(const std::string& what) : Exception(what) { }
 };
 
+class Graph::AbortedException : public Graph::Exception {
+    public: AbortedException(const std::string& what) : Exception(what) { }
+};
+
 
 /* --------------------------------------------------------------------------------------------- */
 
@@ -192,11 +308,11 @@ T& Graph::makeNode(T&& node)
     }
 
     // if not, create a new node
-    auto ret = m_nodes.insert(it, new T(std::move(node)));
+    T* pNewNode = new T(std::move(node));
+    m_nodes.insert(it, pNewNode);
 
-    // ret.first is an iterator to the new element. 
-    // We must dereference it twice (iterator & unique_ptr) in order to get the node reference.
-    return **ret;
+    // return the derived type, the set only knows the Node base class
+    return *pNewNode;
 }
 
 
@@ -206,11 +322,11 @@ template<class T>
 T& Graph::makeEdge(T&& edge)
 {
     // check if src and destination nodes are in the graph
-    if (std::find(m_nodes.begin(), m_nodes.end(), &edge.getDstNode()) == m_nodes.end()) {
+    if (!contains(edge.getDstNode())) {
         throw InvalidNodeException("source node is not in the graph");
     }
 
-    if (std::find(m_nodes.begin(), m_nodes.end(), &edge.getSrcNode()) == m_nodes.end()) {
+    if (!contains(edge.getSrcNode())) {
         throw InvalidNodeException("destination node is not in the graph");
     }
 
@@ -0,0 +1,453 @@
+#include "GraphSnapshot.h"
+#include "Landmarks.h"
+#include "NodeIndex.h"
+
+#include <limits>
+#include <functional>
+#include <algorithm>
+
+
+// the same 32-bit indices as in the snapshot
+typedef std::vector<std::uint32_t> tIndices;
+typedef std::vector<tIndices> tAdjacency;
+
+
+//-------------------------------------------------------------------------------------------------
+
+/** Visits each connected component in breadth first order. */
+static tIndices orderBreadthFirst(const tAdjacency& neighbours)
+{
+    tIndices order;
+    std::vector<bool> visited(neighbours.size(), false);
+
+    for (size_t start = 0; start < neighbours.size(); start++) {
+        if (visited[start]) continue;
+
+        size_t head = order.size();
+        order.push_back(start);
+        visited[start] = true;
+        // the order itself is used as queue
+        while (head < order.size()) {
+            for (size_t v : neighbours[order[head++]]) {
+                if (!visited[v]) {
+                    visited[v] = true;
+                    order.push_back(v);
+                }
+            }
+        }
+    }
+
+    return order;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+/** Visits each connected component in depth first pre-order. */
+static tIndices orderDepthFirst(const tAdjacency& neighbours)
+{
+    tIndices order;
+    tIndices stack;
+    std::vector<bool> visited(neighbours.size(), false);
+
+    for (size_t start = 0; start < neighbours.size(); start++) {
+        stack.push_back(start);
+        while (!stack.empty()) {
+            size_t u = stack.back();
+            stack.pop_back();
+            if (visited[u]) continue;
+
+            visited[u] = true;
+            order.push_back(u);
+            // push in reverse order, so the first neighbour is visited first
+            for (auto it = neighbours[u].rbegin(); it != neighbours[u].rend(); it++) {
+                if (!visited[*it]) stack.push_back(*it);
+            }
+        }
+    }
+
+    return order;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+/**
+* Reverse Cuthill-McKee: breadth first from a node with minimal degree, neighbours are visited
+* by increasing degree. The reversed order reduces the bandwidth of the adjacency matrix.
+*/
+static tIndices orderReverseCuthillMcKee(const tAdjacency& neighbours)
+{
+    auto byDegree = [&](size_t l, size_t r) {
+        return neighbours[l].size() < neighbours[r].size();
+    };
+
+    tIndices starts(neighbours.size());
+    for (size_t i = 0; i < starts.size(); i++) starts[i] = i;
+    std::stable_sort(starts.begin(), starts.end(), byDegree);
+
+    tIndices order;
+    tIndices candidates;
+    std::vector<bool> visited(neighbours.size(), false);
+
+    for (size_t start : starts) {
+        if (visited[start]) continue;
+
+        size_t head = order.size();
+        order.push_back(start);
+        visited[start] = true;
+        while (head < order.size()) {
+            candidates.clear();
+            for (size_t v : neighbours[order[head++]]) {
+                if (!visited[v]) {
+                    visited[v] = true;
+                    candidates.push_back(v);
+                }
+            }
+            std::stable_sort(candidates.begin(), candidates.end(), byDegree);
+            order.insert(order.end(), candidates.begin(), candidates.end());
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+/** The distance of the cell (x, y) along a Hilbert curve through a n x n grid. */
+static unsigned long long getHilbertDistance(unsigned long long n, unsigned long long x, unsigned long long y)
+{
+    // see https://en.wikipedia.org/wiki/Hilbert_curve
+    unsigned long long d = 0;
+    for (unsigned long long s = n / 2; s > 0; s /= 2) {
+        unsigned long long rx = (x & s) > 0;
+        unsigned long long ry = (y & s) > 0;
+        d += s * s * ((3 * rx) ^ ry);
+        // rotate the quadrant
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+/** Sorts the nodes along a Hilbert curve. Nodes without coordinates are appended at the end. */
+static tIndices orderHilbert(const GraphSnapshot::tNodes& nodes)
+{
+    const unsigned long long gridSize = 1 << 16;
+
+    std::vector<double> xs(nodes.size()), ys(nodes.size());
+    std::vector<bool> hasCoordinates(nodes.size());
+    double minX = std::numeric_limits<double>::max(), maxX = -minX;
+    double minY = minX, maxY = -minX;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        hasCoordinates[i] = nodes[i]->getCoordinates(xs[i], ys[i]);
+        if (hasCoordinates[i]) {
+            minX = std::min(minX, xs[i]);
+            maxX = std::max(maxX, xs[i]);
+            minY = std::min(minY, ys[i]);
+            maxY = std::max(maxY, ys[i]);
+        }
+    }
+
+    // scale the bounding box to the grid
+    double scale = std::max(maxX - minX, maxY - minY);
+    scale = scale > 0 ? (gridSize - 1) / scale : 0;
+
+    std::vector<unsigned long long> keys(nodes.size(), std::numeric_limits<unsigned long long>::max());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (hasCoordinates[i]) {
+            keys[i] = getHilbertDistance(gridSize,
+                static_cast<unsigned long long>((xs[i] - minX) * scale),
+                static_cast<unsigned long long>((ys[i] - minY) * scale));
+        }
+    }
+
+    tIndices order(nodes.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t l, size_t r) { return keys[l] < keys[r]; });
+
+    return order;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+GraphSnapshot::GraphSnapshot(const Graph& rGraph, Graph::NodeOrder order, unsigned long long epoch,
+        Graph::tRetiredObjects& rRetired)
+    : m_epoch(epoch), m_pRetired(&rRetired)
+{
+    // first, the nodes are numbered by id
+    tNodes nodesById(rGraph.m_nodes.begin(), rGraph.m_nodes.end());
+    NodeIndex idIndex(nodesById.begin(), nodesById.end());
+    auto getIdIndex = [&](const Node& rNode) { return idIndex.getIndex(rNode); };
+
+    tAdjacency neighbours;
+    if (order == Graph::ORDER_BFS || order == Graph::ORDER_DFS || order == Graph::ORDER_RCM) {
+        // the orderings ignore the direction of the edges
+        neighbours.resize(nodesById.size());
+        for (Edge* pEdge : rGraph.m_edges) {
+            tIndex src = getIdIndex(pEdge->getSrcNode());
+            tIndex dst = getIdIndex(pEdge->getDstNode());
+            neighbours[src].push_back(dst);
+            neighbours[dst].push_back(src);
+        }
+    }
+
+    // layout[k] is the id index of the k-th node in memory
+    tIndices layout;
+    switch (order) {
+    case Graph::ORDER_BFS:     layout = orderBreadthFirst(neighbours); break;
+    case Graph::ORDER_DFS:     layout = orderDepthFirst(neighbours); break;
+    case Graph::ORDER_RCM:     layout = orderReverseCuthillMcKee(neighbours); break;
+    case Graph::ORDER_HILBERT: layout = orderHilbert(nodesById); break;
+    default:
+        layout.resize(nodesById.size());
+        for (size_t i = 0; i < layout.size(); i++) layout[i] = i;
+    }
+
+    m_nodes.resize(layout.size());
+    m_nodesById.resize(layout.size());
+    for (size_t k = 0; k < layout.size(); k++) {
+        m_nodes[k] = nodesById[layout[k]];
+        m_nodesById[layout[k]] = k;
+    }
+
+    // copy the outgoing edges of each node into one contiguous array
+    m_firstArc.reserve(m_nodes.size() + 1);
+    m_arcs.reserve(rGraph.m_edges.size());
+    m_arcEdges.reserve(rGraph.m_edges.size());
+    std::vector<std::pair<tArc, Edge*>> outArcs;
+    for (Node* pNode : m_nodes) {
+        m_firstArc.push_back(m_arcs.size());
+
+        outArcs.clear();
+        for (Edge* pEdge : pNode->getOutEdges()) {
+            tArc arc = { m_nodesById[getIdIndex(pEdge->getDstNode())], pEdge->getWeight() };
+            outArcs.push_back(std::make_pair(arc, pEdge));
+        }
+        // visit the neighbours in memory order
+        std::stable_sort(outArcs.begin(), outArcs.end(),
+            [](const std::pair<tArc, Edge*>& l, const std::pair<tArc, Edge*>& r) {
+                return l.first.dst < r.first.dst;
+            });
+
+        for (auto& rOutArc : outArcs) {
+            m_arcs.push_back(rOutArc.first);
+            m_arcEdges.push_back(rOutArc.second);
+        }
+    }
+    m_firstArc.push_back(m_arcs.size());
+
+    // counted last, so the destructor runs exactly for the counted snapshots
+    m_pRetired->numSnapshots.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+GraphSnapshot::~GraphSnapshot()
+{
+    // the release order makes all reads of this snapshot happen before the graph frees the objects
+    m_pRetired->numSnapshots.fetch_sub(1, std::memory_order_release);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+size_t GraphSnapshot::getMemoryUsage() const
+{
+    return sizeof(GraphSnapshot)
+        + m_nodes.capacity() * sizeof(Node*)
+        + m_nodesById.capacity() * sizeof(tIndex)
+        + m_firstArc.capacity() * sizeof(size_t)
+        + m_arcs.capacity() * sizeof(tArc)
+        + m_arcEdges.capacity() * sizeof(Edge*);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+GraphSnapshot::tIndices::const_iterator GraphSnapshot::lowerBound(const std::string& id) const
+{
+    return std::lower_bound(m_nodesById.begin(), m_nodesById.end(), id,
+        [this](tIndex index, const std::string& id) { return m_nodes[index]->getId() < id; });
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Node* GraphSnapshot::findNodeById(const std::string& id) const
+{
+    auto it = lowerBound(id);
+    if (it != m_nodesById.end() && m_nodes[*it]->getId() == id) {
+        return m_nodes[*it];
+    }
+
+    return NULL;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+size_t GraphSnapshot::getIndex(const Node& rNode) const
+{
+    auto it = lowerBound(rNode.getId());
+    if (it == m_nodesById.end() || m_nodes[*it] != &rNode) {
+        throw Graph::InvalidNodeException("node is not in the snapshot: " + rNode.getId());
+    }
+
+    return *it;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+GraphSnapshot::tPath GraphSnapshot::findShortestPathDijkstra(const Node& rSrc, const Node& rDst) const
+{
+    Workspace workspace;
+    return findShortestPathDijkstra(rSrc, rDst, workspace);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+GraphSnapshot::tPath GraphSnapshot::findShortestPathDijkstra(const Node& rSrc, const Node& rDst,
+        Workspace& rWorkspace, const tAbortCheck& isAborted) const
+{
+    return search(getIndex(rSrc), getIndex(rDst), rWorkspace, isAborted, NULL);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+GraphSnapshot::tPath GraphSnapshot::search(size_t src, size_t dst, Workspace& rWorkspace,
+        const tAbortCheck& isAborted, const Landmarks* pLandmarks) const
+{
+    const double infinity = std::numeric_limits<double>::max();
+
+    // all query state is in the workspace, so concurrent queries do not interfere
+    Workspace& w = rWorkspace;
+    w.reset(m_nodes.size());
+    w.update(src, 0, m_nodes.size(), m_arcs.size());
+    w.setPotential(src, pLandmarks != NULL ? pLandmarks->getLowerBound(src, dst) : 0);
+    w.push(w.m_potential[src], src);
+
+    size_t numSettled = 0;
+    while (!w.m_queue.empty()) {
+        Workspace::tQueueEntry top = w.pop();
+
+        size_t u = top.second;
+        // skip outdated queue entries
+        if (top.first > w.m_distance[u] + w.m_potential[u]) {
+            continue;
+        }
+
+        if (u == dst) {
+            break;
+        }
+
+        // do not call the abort check for each node, it might be expensive
+        if (isAborted && ++numSettled % 256 == 0 && isAborted()) {
+            throw Graph::AbortedException("search aborted");
+        }
+
+        for (size_t a = m_firstArc[u]; a < m_firstArc[u + 1]; a++) {
+            const tArc& arc = m_arcs[a];
+            double newDistance = w.m_distance[u] + arc.weight;
+            if (!w.isReached(arc.dst)) {
+                double potential = pLandmarks != NULL ? pLandmarks->getLowerBound(arc.dst, dst) : 0;
+                // an infinite lower bound proves, that the destination is unreachable from here
+                if (potential >= infinity) {
+                    continue;
+                }
+                w.update(arc.dst, newDistance, u, a);
+                w.setPotential(arc.dst, potential);
+                w.push(newDistance + potential, arc.dst);
+            }
+            else if (newDistance < w.m_distance[arc.dst]) {
+                // settled nodes are reopened, which keeps ALT exact with rounded bounds
+                w.update(arc.dst, newDistance, u, a);
+                w.push(newDistance + w.m_potential[arc.dst], arc.dst);
+            }
+        }
+    }
+
+    // insert the path to a deque, it stays empty if no path was found
+    tPath path;
+    if (w.isReached(dst)) {
+        size_t current = dst;
+        while (w.m_prevNode[current] != m_nodes.size()) {
+            path.push_front(m_arcEdges[w.m_prevArc[current]]);
+            current = w.m_prevNode[current];
+        }
+    }
+
+    return path;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void GraphSnapshot::Workspace::reset(size_t numNodes)
+{
+    m_queue.clear();
+
+    if (m_reachedInRound.size() < numNodes) {
+        m_reachedInRound.resize(numNodes, m_round);
+        m_distance.resize(numNodes);
+        m_prevNode.resize(numNodes);
+        m_prevArc.resize(numNodes);
+        m_potential.resize(numNodes);
+    }
+
+    // invalidate all entries at once. On overflow, the entries must be cleared explicitly.
+    m_round += 1;
+    if (m_round == 0) {
+        std::fill(m_reachedInRound.begin(), m_reachedInRound.end(), 0);
+        m_round = 1;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void GraphSnapshot::Workspace::update(size_t node, double distance, size_t prevNode, size_t prevArc)
+{
+    m_reachedInRound[node] = m_round;
+    m_distance[node] = distance;
+    m_prevNode[node] = prevNode;
+    m_prevArc[node] = prevArc;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void GraphSnapshot::Workspace::push(double key, size_t node)
+{
+    m_queue.push_back(tQueueEntry(key, node));
+    std::push_heap(m_queue.begin(), m_queue.end(), std::greater<tQueueEntry>());
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+GraphSnapshot::Workspace::tQueueEntry GraphSnapshot::Workspace::pop()
+{
+    std::pop_heap(m_queue.begin(), m_queue.end(), std::greater<tQueueEntry>());
+    tQueueEntry top = m_queue.back();
+    m_queue.pop_back();
+    return top;
+}
+
+
+//-------------------------------------------------------------------------------------------------
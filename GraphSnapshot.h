@@ -0,0 +1,222 @@
+#ifndef GRAPHSNAPSHOT_H
+#define GRAPHSNAPSHOT_H
+
+#include <deque>
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <limits>
+#include <cstdint>
+
+#include "Graph.h"
+
+class Landmarks;
+class Overlay;
+template<class W> class CompactGraph;
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* An immutable, versioned view of a Graph, as created by Graph::publishSnapshot().
+* The adjacency and the edge weights are copied into compact arrays, so the snapshot can be
+* queried from any number of threads while the writer keeps modifying the graph.
+* The nodes and edges referenced by the snapshot stay alive as long as the snapshot exists.
+*/
+class GraphSnapshot
+{
+
+public:
+
+    //! @Datataypes
+
+    typedef std::deque<Edge*> tPath;
+    typedef std::vector<Node*> tNodes;
+
+    /** Returns true, if a running search shall be aborted. */
+    typedef std::function<bool()> tAbortCheck;
+
+    class Workspace;
+
+
+public:
+
+    //! @Lifetime
+
+    /** Lets the next Graph::publishSnapshot() free the removed objects kept for this snapshot. */
+    ~GraphSnapshot();
+
+
+public:
+
+    //! @Snapshot Information
+
+    /** The version of the graph. Each call of Graph::publishSnapshot() increments it. */
+    unsigned long long getEpoch() const { return m_epoch; }
+
+    size_t getNumNodes() const { return m_nodes.size(); }
+
+    size_t getNumEdges() const { return m_arcs.size(); }
+
+    /** All nodes of the snapshot in the order of their memory layout. */
+    const tNodes& getNodes() const { return m_nodes; }
+
+    /**
+    * Retrieves a node by the given id.
+    * @return a pointer to the node or NULL if not found.
+    */
+    Node* findNodeById(const std::string& id) const;
+
+    /**
+    * The memory of the snapshot arrays in bytes. The nodes and edges belong to the graph.
+    * Each node needs 20 bytes, each edge 24 bytes. See CompactGraph for less memory.
+    */
+    size_t getMemoryUsage() const;
+
+
+    //! @Routing
+
+    /**
+    * Calculate the shortest path from a source node to a destination node.
+    * The edge weights are the ones at the time the snapshot was published.
+    * @param rSrc the source node.
+    * @param rDst the destination node.
+    * @return tPath is a deque of edges and represents the route from rSrc to rDst.
+    * @throw Graph::InvalidNodeException if a node is not part of the snapshot.
+    */
+    tPath findShortestPathDijkstra(const Node& rSrc, const Node& rDst) const;
+
+    /**
+    * Calculate the shortest path like above, but reuse the memory of the given workspace.
+    * @param rWorkspace the search state. Use one workspace per thread.
+    * @param isAborted is called regularly during the search, if set.
+    * @throw Graph::AbortedException if isAborted returned true.
+    */
+    tPath findShortestPathDijkstra(const Node& rSrc, const Node& rDst,
+        Workspace& rWorkspace, const tAbortCheck& isAborted = tAbortCheck()) const;
+
+
+private:
+
+    // 32-bit node indices, as in CompactGraph
+    typedef std::uint32_t tIndex;
+
+    // an outgoing edge in the adjacency array. The edge itself is kept apart in m_arcEdges,
+    // since the searches only need it to build the path.
+    struct tArc
+    {
+        tIndex dst;
+        double weight;
+    };
+
+    typedef std::vector<tArc> tArcs;
+    typedef std::vector<tIndex> tIndices;
+    typedef std::vector<size_t> tOffsets;
+
+    GraphSnapshot(const Graph& rGraph, Graph::NodeOrder order, unsigned long long epoch,
+        Graph::tRetiredObjects& rRetired);
+
+    GraphSnapshot(const GraphSnapshot&) = delete;
+    GraphSnapshot& operator=(const GraphSnapshot&) = delete;
+
+    /** @return the index of the given node or throws Graph::InvalidNodeException. */
+    size_t getIndex(const Node& rNode) const;
+
+    /**
+    * The shortest path search. Without landmarks, this is Dijkstra's algorithm,
+    * with landmarks it is an A* search with the landmark lower bounds as potential (ALT).
+    */
+    tPath search(size_t src, size_t dst, Workspace& rWorkspace, const tAbortCheck& isAborted,
+        const Landmarks* pLandmarks) const;
+
+    /** @return an iterator into m_nodesById to the first node with an id not less than id. */
+    tIndices::const_iterator lowerBound(const std::string& id) const;
+
+    unsigned long long m_epoch;
+
+    tNodes m_nodes;
+
+    // the indices of m_nodes, sorted by node id
+    tIndices m_nodesById;
+
+    // the outgoing arcs of node i are m_arcs[m_firstArc[i]] .. m_arcs[m_firstArc[i + 1] - 1]
+    tOffsets m_firstArc;
+    tArcs m_arcs;
+
+    // the edge of each arc
+    std::vector<Edge*> m_arcEdges;
+
+    // keeps the nodes and edges alive, that are removed from the graph after publishing
+    Graph::tRetiredObjects* m_pRetired;
+
+    friend class Graph;
+    friend class Landmarks;
+    friend class Overlay;
+    template<class W> friend class CompactGraph;
+
+#ifdef TESTING
+    friend class GraphTesting;
+#endif
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* The state of a search. A workspace can be reused for many searches on any snapshot,
+* which avoids to allocate and initialize the arrays for each search.
+*/
+class GraphSnapshot::Workspace
+{
+
+public:
+
+    Workspace() : m_round(0) { }
+
+    Workspace(const Workspace&) = delete;
+    Workspace& operator=(const Workspace&) = delete;
+
+
+private:
+
+    typedef std::pair<double, size_t> tQueueEntry;
+
+    /** Invalidates all entries, so that a new search can start. */
+    void reset(size_t numNodes);
+
+    bool isReached(size_t node) const { return m_reachedInRound[node] == m_round; }
+
+    double getDistance(size_t node) const {
+        return isReached(node) ? m_distance[node] : std::numeric_limits<double>::max();
+    }
+
+    void update(size_t node, double distance, size_t prevNode, size_t prevArc);
+
+    /** Sets the potential of a node, that is reached for the first time. */
+    void setPotential(size_t node, double potential) { m_potential[node] = potential; }
+
+    void push(double key, size_t node);
+
+    tQueueEntry pop();
+
+    // an entry i is only valid, if m_reachedInRound[i] == m_round
+    unsigned int m_round;
+    std::vector<unsigned int> m_reachedInRound;
+    std::vector<double> m_distance;
+    std::vector<size_t> m_prevNode;
+    std::vector<size_t> m_prevArc;
+    std::vector<double> m_potential;
+
+    // binary min-heap of (key, node)
+    std::vector<tQueueEntry> m_queue;
+
+    friend class GraphSnapshot;
+    friend class Overlay;
+    template<class W> friend class CompactGraph;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,367 @@
+#include "Landmarks.h"
+#include "Parallel.h"
+
+#include <limits>
+#include <cfloat>
+#include <algorithm>
+#include <functional>
+
+
+//-------------------------------------------------------------------------------------------------
+
+/** @return the lower bound a - b for a triangle inequality, corrected by the rounding to float. */
+static double getDifference(float a, float b)
+{
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    if (b == infinity) {
+        return 0;
+    }
+    if (a == infinity) {
+        return infinity;
+    }
+
+    // each float has a relative rounding error of at most FLT_EPSILON / 2
+    return (double(a) - double(b)) - (double(a) + double(b)) * FLT_EPSILON;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+/**
+* Rounds a distance for the tables. Only unreachable nodes get an infinite distance, larger
+* finite distances are clamped to FLT_MAX. The bounds stay valid: a clamped minuend only lowers
+* a difference, and a clamped subtrahend is larger than any minuend, that was not clamped.
+*/
+static float toTableDistance(double distance)
+{
+    if (distance == std::numeric_limits<double>::infinity()) {
+        return std::numeric_limits<float>::infinity();
+    }
+    return float(std::min(distance, double(FLT_MAX)));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Landmarks::Landmarks(const std::shared_ptr<const GraphSnapshot>& pSnapshot, size_t numLandmarks,
+        Selection selection, size_t numThreads)
+    : m_pSnapshot(pSnapshot)
+{
+    size_t numNodes = m_pSnapshot->getNumNodes();
+    m_numLandmarks = std::min(numLandmarks, numNodes);
+
+    m_distanceFrom.assign(numNodes * m_numLandmarks, std::numeric_limits<float>::infinity());
+    m_distanceTo.assign(numNodes * m_numLandmarks, std::numeric_limits<float>::infinity());
+
+    if (m_numLandmarks == 0) {
+        return;
+    }
+
+    // the selection is sequential, since each landmark depends on the previous ones
+    selectFirst();
+    if (selection == SELECT_FARTHEST) {
+        selectFarthest();
+    }
+    else {
+        selectAvoid();
+    }
+
+    calculateDistancesTo(numThreads);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Landmarks::tNodes Landmarks::getLandmarks() const
+{
+    tNodes landmarks;
+    for (size_t landmark : m_landmarks) {
+        landmarks.push_back(m_pSnapshot->m_nodes[landmark]);
+    }
+    return landmarks;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+double Landmarks::getLowerBound(const Node& rSrc, const Node& rDst) const
+{
+    return getLowerBound(m_pSnapshot->getIndex(rSrc), m_pSnapshot->getIndex(rDst));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+double Landmarks::getLowerBound(size_t src, size_t dst) const
+{
+    const float* pFromSrc = &m_distanceFrom[src * m_numLandmarks];
+    const float* pFromDst = &m_distanceFrom[dst * m_numLandmarks];
+    const float* pToSrc = &m_distanceTo[src * m_numLandmarks];
+    const float* pToDst = &m_distanceTo[dst * m_numLandmarks];
+
+    double bound = 0;
+    for (size_t l = 0; l < m_numLandmarks; l++) {
+        // d(src, dst) >= d(L, dst) - d(L, src)
+        bound = std::max(bound, getDifference(pFromDst[l], pFromSrc[l]));
+        // d(src, dst) >= d(src, L) - d(dst, L)
+        bound = std::max(bound, getDifference(pToSrc[l], pToDst[l]));
+    }
+
+    return bound;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+size_t Landmarks::getMemoryUsage() const
+{
+    return sizeof(Landmarks)
+        + m_landmarks.capacity() * sizeof(size_t)
+        + (m_distanceFrom.capacity() + m_distanceTo.capacity()) * sizeof(float);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Landmarks::tPath Landmarks::findShortestPath(const Node& rSrc, const Node& rDst) const
+{
+    GraphSnapshot::Workspace workspace;
+    return findShortestPath(rSrc, rDst, workspace);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Landmarks::tPath Landmarks::findShortestPath(const Node& rSrc, const Node& rDst,
+        GraphSnapshot::Workspace& rWorkspace, const GraphSnapshot::tAbortCheck& isAborted) const
+{
+    return m_pSnapshot->search(m_pSnapshot->getIndex(rSrc), m_pSnapshot->getIndex(rDst),
+        rWorkspace, isAborted, this);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void Landmarks::selectFirst()
+{
+    const GraphSnapshot& rSnapshot = *m_pSnapshot;
+    std::vector<double> distance;
+
+    calculateDistances(0, rSnapshot.m_firstArc, rSnapshot.m_arcs, distance);
+
+    size_t farthest = 0;
+    for (size_t v = 0; v < distance.size(); v++) {
+        if (distance[v] != std::numeric_limits<double>::infinity() && distance[v] > distance[farthest]) {
+            farthest = v;
+        }
+    }
+
+    addLandmark(farthest, distance);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void Landmarks::selectFarthest()
+{
+    size_t numNodes = m_pSnapshot->getNumNodes();
+    std::vector<double> distance;
+
+    // the smallest distance of each node from any landmark
+    std::vector<double> minDistance(numNodes, std::numeric_limits<double>::infinity());
+    std::vector<bool> isLandmark(numNodes, false);
+
+    for (size_t l = 0; l < m_landmarks.size(); l++) {
+        isLandmark[m_landmarks[l]] = true;
+        for (size_t v = 0; v < numNodes; v++) {
+            minDistance[v] = std::min(minDistance[v], double(m_distanceFrom[v * m_numLandmarks + l]));
+        }
+    }
+
+    while (m_landmarks.size() < m_numLandmarks) {
+        // unreachable nodes are the farthest ones, so each component gets a landmark
+        size_t next = numNodes;
+        for (size_t v = 0; v < numNodes; v++) {
+            if (!isLandmark[v] && (next == numNodes || minDistance[v] > minDistance[next])) {
+                next = v;
+            }
+        }
+
+        addLandmark(next, distance);
+        isLandmark[next] = true;
+        for (size_t v = 0; v < numNodes; v++) {
+            minDistance[v] = std::min(minDistance[v], distance[v]);
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+/**
+* This is based on the avoid heuristic by Goldberg and Werneck: build a shortest path tree from
+* a root node and weight each node by how much the current lower bound underestimates its distance.
+* The next landmark is a leaf in the heaviest subtree, that does not contain a landmark yet.
+*/
+void Landmarks::selectAvoid()
+{
+    const GraphSnapshot& rSnapshot = *m_pSnapshot;
+    size_t numNodes = rSnapshot.getNumNodes();
+
+    std::vector<double> distance;
+    tIndices order;
+    tIndices parent;
+
+    std::vector<bool> isLandmark(numNodes, false);
+    for (size_t landmark : m_landmarks) isLandmark[landmark] = true;
+
+    while (m_landmarks.size() < m_numLandmarks) {
+        // choose a pseudo random root, that is not a landmark
+        size_t root = (m_landmarks.size() * 2654435761ULL) % numNodes;
+        while (isLandmark[root]) root = (root + 1) % numNodes;
+
+        calculateDistances(root, rSnapshot.m_firstArc, rSnapshot.m_arcs, distance, &order, &parent);
+
+        // size of the subtree below each node, 0 if the subtree contains a landmark
+        std::vector<double> size(numNodes, 0);
+        std::vector<bool> containsLandmark(numNodes, false);
+        tIndices heaviestChild(numNodes, numNodes);
+
+        for (auto it = order.rbegin(); it != order.rend(); it++) {
+            size_t v = *it;
+
+            // the bound from the root only uses the distances from the landmarks so far
+            double bound = 0;
+            for (size_t l = 0; l < m_landmarks.size(); l++) {
+                bound = std::max(bound, getDifference(m_distanceFrom[v * m_numLandmarks + l],
+                                                      m_distanceFrom[root * m_numLandmarks + l]));
+            }
+            size[v] += std::max(0.0, distance[v] - bound);
+
+            containsLandmark[v] = containsLandmark[v] || isLandmark[v];
+            if (containsLandmark[v]) {
+                size[v] = 0;
+            }
+
+            size_t p = parent[v];
+            if (p != numNodes) {
+                containsLandmark[p] = containsLandmark[p] || containsLandmark[v];
+                size[p] += size[v];
+                if (heaviestChild[p] == numNodes || size[v] > size[heaviestChild[p]]) {
+                    heaviestChild[p] = v;
+                }
+            }
+        }
+
+        // follow the heaviest subtrees down to a leaf. Subtrees with a landmark have size 0,
+        // so this never selects a landmark twice.
+        size_t next = root;
+        while (heaviestChild[next] != numNodes && size[heaviestChild[next]] > 0) {
+            next = heaviestChild[next];
+        }
+
+        addLandmark(next, distance);
+        isLandmark[next] = true;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void Landmarks::addLandmark(size_t landmark, std::vector<double>& rDistance)
+{
+    const GraphSnapshot& rSnapshot = *m_pSnapshot;
+    calculateDistances(landmark, rSnapshot.m_firstArc, rSnapshot.m_arcs, rDistance);
+
+    size_t l = m_landmarks.size();
+    for (size_t v = 0; v < rDistance.size(); v++) {
+        m_distanceFrom[v * m_numLandmarks + l] = toTableDistance(rDistance[v]);
+    }
+
+    m_landmarks.push_back(landmark);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void Landmarks::calculateDistancesTo(size_t numThreads)
+{
+    const GraphSnapshot& rSnapshot = *m_pSnapshot;
+    size_t numNodes = rSnapshot.getNumNodes();
+
+    // the distances to a landmark are calculated on the reversed edges
+    GraphSnapshot::tOffsets firstArc(numNodes + 1, 0);
+    for (const GraphSnapshot::tArc& arc : rSnapshot.m_arcs) {
+        firstArc[arc.dst + 1] += 1;
+    }
+    for (size_t v = 0; v < numNodes; v++) {
+        firstArc[v + 1] += firstArc[v];
+    }
+
+    GraphSnapshot::tArcs arcs(rSnapshot.m_arcs.size());
+    GraphSnapshot::tOffsets next(firstArc.begin(), firstArc.end() - 1);
+    for (size_t u = 0; u < numNodes; u++) {
+        for (size_t a = rSnapshot.m_firstArc[u]; a < rSnapshot.m_firstArc[u + 1]; a++) {
+            const GraphSnapshot::tArc& arc = rSnapshot.m_arcs[a];
+            GraphSnapshot::tArc reverseArc = { GraphSnapshot::tIndex(u), arc.weight };
+            arcs[next[arc.dst]++] = reverseArc;
+        }
+    }
+
+    // each thread calculates the tables of a range of landmarks
+    parallelFor(numThreads, m_numLandmarks, [&](size_t, size_t begin, size_t end) {
+        std::vector<double> distance;
+        for (size_t l = begin; l < end; l++) {
+            calculateDistances(m_landmarks[l], firstArc, arcs, distance);
+            for (size_t v = 0; v < numNodes; v++) {
+                m_distanceTo[v * m_numLandmarks + l] = toTableDistance(distance[v]);
+            }
+        }
+    });
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void Landmarks::calculateDistances(size_t src, const GraphSnapshot::tOffsets& firstArc,
+        const GraphSnapshot::tArcs& arcs, std::vector<double>& rDistance, tIndices* pOrder, tIndices* pParent)
+{
+    size_t numNodes = firstArc.size() - 1;
+    rDistance.assign(numNodes, std::numeric_limits<double>::infinity());
+    if (pOrder != NULL) pOrder->clear();
+    if (pParent != NULL) pParent->assign(numNodes, numNodes);
+
+    typedef std::pair<double, size_t> tQueueEntry;
+    std::vector<tQueueEntry> Q;
+
+    rDistance[src] = 0;
+    Q.push_back(tQueueEntry(0, src));
+
+    while (!Q.empty()) {
+        std::pop_heap(Q.begin(), Q.end(), std::greater<tQueueEntry>());
+        tQueueEntry top = Q.back();
+        Q.pop_back();
+
+        size_t u = top.second;
+        // skip outdated queue entries
+        if (top.first > rDistance[u]) {
+            continue;
+        }
+
+        if (pOrder != NULL) pOrder->push_back(u);
+
+        for (size_t a = firstArc[u]; a < firstArc[u + 1]; a++) {
+            double newDistance = rDistance[u] + arcs[a].weight;
+            if (newDistance < rDistance[arcs[a].dst]) {
+                rDistance[arcs[a].dst] = newDistance;
+                if (pParent != NULL) (*pParent)[arcs[a].dst] = u;
+                Q.push_back(tQueueEntry(newDistance, arcs[a].dst));
+                std::push_heap(Q.begin(), Q.end(), std::greater<tQueueEntry>());
+            }
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
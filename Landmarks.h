@@ -0,0 +1,139 @@
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include <vector>
+#include <memory>
+#include <thread>
+
+#include "GraphSnapshot.h"
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* Landmark preprocessing for goal-directed searches (ALT: A*, landmarks, triangle inequality).
+* The distances from and to a few landmark nodes are stored for all nodes of a snapshot.
+* Because of the triangle inequality, they give a lower bound for the distance between any two
+* nodes, which guides the search towards the destination. No node coordinates are required.
+*/
+class Landmarks
+{
+
+public:
+
+    //! @Datataypes
+
+    typedef GraphSnapshot::tPath tPath;
+    typedef GraphSnapshot::tNodes tNodes;
+
+    /**
+    * SELECT_FARTHEST adds the node with the largest distance to all landmarks so far.
+    * SELECT_AVOID adds a node in a region of the graph, where the lower bounds are weak.
+    */
+    enum Selection { SELECT_FARTHEST, SELECT_AVOID };
+
+
+public:
+
+    //! @Lifetime
+
+    /**
+    * Selects the landmarks and calculates their distance tables.
+    * @param pSnapshot the graph. The landmarks keep the snapshot alive.
+    * @param numLandmarks the number of landmarks. Each one needs 8 bytes per node.
+    * @param selection the strategy to select the landmarks.
+    * @param numThreads the number of threads to calculate the distance tables.
+    */
+    Landmarks(const std::shared_ptr<const GraphSnapshot>& pSnapshot, size_t numLandmarks,
+        Selection selection = SELECT_AVOID, size_t numThreads = std::thread::hardware_concurrency());
+
+    Landmarks(const Landmarks&) = delete;
+    Landmarks& operator=(const Landmarks&) = delete;
+
+
+    //! @Landmark Information
+
+    const std::shared_ptr<const GraphSnapshot>& getSnapshot() const { return m_pSnapshot; }
+
+    /** The selected landmark nodes. */
+    tNodes getLandmarks() const;
+
+    /**
+    * @return a lower bound for the distance from rSrc to rDst. It is infinite, if there is no path.
+    * @throw Graph::InvalidNodeException if a node is not part of the snapshot.
+    */
+    double getLowerBound(const Node& rSrc, const Node& rDst) const;
+
+    /** The memory of the distance tables in bytes, without the snapshot. */
+    size_t getMemoryUsage() const;
+
+
+    //! @Routing
+
+    /**
+    * Calculate the shortest path from a source node to a destination node with an A* search,
+    * that uses the landmark lower bounds. The result is the same as of Dijkstra's algorithm.
+    * @throw Graph::InvalidNodeException if a node is not part of the snapshot.
+    */
+    tPath findShortestPath(const Node& rSrc, const Node& rDst) const;
+
+    /**
+    * Calculate the shortest path like above, but reuse the memory of the given workspace.
+    * @throw Graph::AbortedException if isAborted returned true.
+    */
+    tPath findShortestPath(const Node& rSrc, const Node& rDst, GraphSnapshot::Workspace& rWorkspace,
+        const GraphSnapshot::tAbortCheck& isAborted = GraphSnapshot::tAbortCheck()) const;
+
+
+private:
+
+    typedef std::vector<size_t> tIndices;
+    typedef std::vector<float> tDistanceTable;
+
+    /** The lower bound for the nodes with the given snapshot indices. */
+    double getLowerBound(size_t src, size_t dst) const;
+
+    /** Selects the first landmark: the node farthest from an arbitrary node. */
+    void selectFirst();
+
+    void selectFarthest();
+
+    void selectAvoid();
+
+    /** Adds the landmark and calculates the distances from it to all nodes. */
+    void addLandmark(size_t landmark, std::vector<double>& rDistance);
+
+    /** Calculates the distances to all landmarks in parallel. */
+    void calculateDistancesTo(size_t numThreads);
+
+    /**
+    * Dijkstra's algorithm from src to all nodes on the given adjacency arrays.
+    * @param pOrder receives the nodes in the order they were settled, if set.
+    * @param pParent receives the parent of each node in the shortest path tree, if set.
+    */
+    static void calculateDistances(size_t src, const GraphSnapshot::tOffsets& firstArc,
+        const GraphSnapshot::tArcs& arcs, std::vector<double>& rDistance,
+        tIndices* pOrder = NULL, tIndices* pParent = NULL);
+
+    std::shared_ptr<const GraphSnapshot> m_pSnapshot;
+
+    // snapshot indices of the landmarks
+    tIndices m_landmarks;
+    size_t m_numLandmarks;
+
+    // the distance from landmark l to node v is at m_distanceFrom[v * m_numLandmarks + l].
+    // Tables are kept per node, so that a lower bound reads a single cache line.
+    tDistanceTable m_distanceFrom;
+    tDistanceTable m_distanceTo;
+
+    friend class GraphSnapshot;
+
+#ifdef TESTING
+    friend class GraphTesting;
+#endif
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
@@ -5,7 +5,7 @@
 #include <iomanip>
 #include <cctype> // fr isalnum() (siehe http://www.cplusplus.com/reference/cctype/isalnum/?kw=isalnum)
 
-int Node::s_numInstances = 0;
+std::atomic<int> Node::s_numInstances(0);
 
 
 //-------------------------------------------------------------------------------------------------
@@ -13,10 +13,8 @@ int Node::s_numInstances = 0;
 Node::Node()
 {
     std::stringstream s;
-    s << "n" << std::setw(4) << std::setfill('0') << s_numInstances;
+    s << "n" << std::setw(4) << std::setfill('0') << s_numInstances.fetch_add(1);
     m_id = s.str();
-
-    s_numInstances += 1;
 }
 
 
@@ -48,4 +46,16 @@ std::list<Node*> Node::getNeighbours(Direction direction)
 }
 
 
+//-------------------------------------------------------------------------------------------------
+
+size_t Node::getMemoryUsage() const
+{
+    // short ids are stored inside the string object itself. An empty string has the capacity
+    // of this buffer, a larger capacity needs memory on the heap.
+    bool isIdInPlace = m_id.capacity() <= std::string().capacity();
+
+    return sizeof(Node) + (isIdInPlace ? 0 : m_id.capacity() + 1);
+}
+
+
 //-------------------------------------------------------------------------------------------------
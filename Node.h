@@ -3,6 +3,8 @@
 
 #include <string>
 #include <list>
+#include <vector>
+#include <atomic>
 
 class Edge;
 
@@ -20,15 +22,30 @@ public:
 
     enum Direction { DIR_IN, DIR_OUT, DIR_BOTH };
 
+    // vectors instead of lists, since a list needs a heap allocation per edge
+    typedef std::vector<Edge*> tEdgePtrs;
+
     virtual ~Node() {}
 
 	const std::string& getId() const { return m_id; }
 
-	std::list<Edge*>& getOutEdges() { return m_outEdges; }
-    std::list<Edge*>& getInEdges() { return m_inEdges; }
+	tEdgePtrs& getOutEdges() { return m_outEdges; }
+    tEdgePtrs& getInEdges() { return m_inEdges; }
 
     std::list<Node*> getNeighbours(Direction direction = DIR_BOTH);
 
+    /**
+    * Override this function, if your nodes have a geometric position.
+    * @return true, if rX and rY were set. The default implementation has no coordinates.
+    */
+    virtual bool getCoordinates(double& /*rX*/, double& /*rY*/) const { return false; }
+
+    /**
+    * The memory of this node in bytes, without its edge lists.
+    * Override this function, if your nodes have additional members.
+    */
+    virtual size_t getMemoryUsage() const;
+
     virtual bool operator==(const Node& rOther) const { return m_id == rOther.m_id; }
     virtual bool operator<(const Node& rOther) const { return m_id < rOther.m_id; }
 
@@ -36,10 +53,11 @@ private:
 
 	std::string m_id;
 
-	std::list<Edge*> m_outEdges;
-    std::list<Edge*> m_inEdges;
+	tEdgePtrs m_outEdges;
+    tEdgePtrs m_inEdges;
 
-    static int s_numInstances;
+    // atomic, since nodes may be created concurrently in different graphs.
+    static std::atomic<int> s_numInstances;
 
 #ifdef TESTING
     friend class GraphTesting;
@@ -0,0 +1,70 @@
+#ifndef NODEINDEX_H
+#define NODEINDEX_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <cstdint>
+
+#include "Graph.h"
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* Numbers the nodes of a sequence by their position and finds the number of a node object
+* in O(log n). Used internally to turn the object graph into index based arrays.
+*/
+class NodeIndex
+{
+
+public:
+
+    typedef std::uint32_t tIndex;
+
+    /**
+    * @param first, last the sequence of Node pointers.
+    * @throw Graph::Exception if there are too many nodes for 32-bit indices.
+    */
+    template<class It>
+    NodeIndex(It first, It last);
+
+    /** @return the position of the node in the sequence. The node must be part of it. */
+    tIndex getIndex(const Node& rNode) const {
+        return std::lower_bound(m_entries.begin(), m_entries.end(), tEntry(&rNode, 0), isBefore)->second;
+    }
+
+
+private:
+
+    typedef std::pair<const Node*, tIndex> tEntry;
+
+    // std::less gives a total order of unrelated pointers, the < operator does not
+    static bool isBefore(const tEntry& l, const tEntry& r) { return std::less<const Node*>()(l.first, r.first); }
+
+    // the nodes sorted by address. A sorted array is much smaller than a map.
+    std::vector<tEntry> m_entries;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+template<class It>
+NodeIndex::NodeIndex(It first, It last)
+{
+    for (It it = first; it != last; it++) {
+        if (m_entries.size() == std::numeric_limits<tIndex>::max()) {
+            throw Graph::Exception("too many nodes for 32-bit indices");
+        }
+        m_entries.push_back(tEntry(*it, tIndex(m_entries.size())));
+    }
+
+    std::sort(m_entries.begin(), m_entries.end(), isBefore);
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,659 @@
+#include "Overlay.h"
+#include "Parallel.h"
+
+#include <limits>
+#include <algorithm>
+
+
+//-------------------------------------------------------------------------------------------------
+
+typedef std::vector<size_t> tIndices;
+
+// an undirected graph with node and edge weights, as used for the bisection
+struct tBisectionGraph
+{
+    tIndices firstArc;
+    tIndices arcs;
+    tIndices arcWeight;
+    tIndices nodeWeight;
+
+    size_t getNumNodes() const { return nodeWeight.size(); }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+
+/**
+* Contracts pairs of neighbouring nodes to a coarser graph (heavy edge matching).
+* @param rCoarseOf receives the coarse node of each node.
+*/
+static tBisectionGraph coarsen(const tBisectionGraph& g, tIndices& rCoarseOf)
+{
+    size_t numNodes = g.getNumNodes();
+    rCoarseOf.assign(numNodes, numNodes);
+
+    // match each node with the unmatched neighbour, that has the heaviest connection
+    size_t numCoarse = 0;
+    for (size_t u = 0; u < numNodes; u++) {
+        if (rCoarseOf[u] != numNodes) continue;
+
+        const size_t none = std::numeric_limits<size_t>::max();
+        size_t best = none;
+        for (size_t a = g.firstArc[u]; a < g.firstArc[u + 1]; a++) {
+            size_t v = g.arcs[a];
+            if (v != u && rCoarseOf[v] == numNodes && (best == none || g.arcWeight[a] > g.arcWeight[best])) {
+                best = a;
+            }
+        }
+
+        rCoarseOf[u] = numCoarse;
+        if (best != none) rCoarseOf[g.arcs[best]] = numCoarse;
+        numCoarse += 1;
+    }
+
+    // the members of each coarse node
+    tIndices firstMember(numCoarse + 1, 0);
+    for (size_t u = 0; u < numNodes; u++) firstMember[rCoarseOf[u] + 1] += 1;
+    for (size_t c = 0; c < numCoarse; c++) firstMember[c + 1] += firstMember[c];
+    tIndices members(numNodes);
+    tIndices next(firstMember.begin(), firstMember.end() - 1);
+    for (size_t u = 0; u < numNodes; u++) members[next[rCoarseOf[u]]++] = u;
+
+    // parallel arcs are merged, arcPos is the position of the arc to a coarse node in the current row
+    tBisectionGraph coarse;
+    coarse.nodeWeight.assign(numCoarse, 0);
+    coarse.firstArc.push_back(0);
+    tIndices arcPos(numCoarse, std::numeric_limits<size_t>::max());
+    for (size_t c = 0; c < numCoarse; c++) {
+        size_t rowStart = coarse.arcs.size();
+        for (size_t m = firstMember[c]; m < firstMember[c + 1]; m++) {
+            size_t u = members[m];
+            coarse.nodeWeight[c] += g.nodeWeight[u];
+            for (size_t a = g.firstArc[u]; a < g.firstArc[u + 1]; a++) {
+                size_t d = rCoarseOf[g.arcs[a]];
+                if (d == c) continue;
+
+                if (arcPos[d] != std::numeric_limits<size_t>::max() && arcPos[d] >= rowStart) {
+                    coarse.arcWeight[arcPos[d]] += g.arcWeight[a];
+                }
+                else {
+                    arcPos[d] = coarse.arcs.size();
+                    coarse.arcs.push_back(d);
+                    coarse.arcWeight.push_back(g.arcWeight[a]);
+                }
+            }
+        }
+        coarse.firstArc.push_back(coarse.arcs.size());
+    }
+
+    return coarse;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+/** @return the nodes in breadth first order from start. Other components follow afterwards. */
+static tIndices getBreadthFirstOrder(const tBisectionGraph& g, size_t start)
+{
+    tIndices order;
+    std::vector<bool> visited(g.getNumNodes(), false);
+
+    for (size_t i = 0; i < g.getNumNodes(); i++) {
+        size_t root = (start + i) % g.getNumNodes();
+        if (visited[root]) continue;
+
+        size_t head = order.size();
+        order.push_back(root);
+        visited[root] = true;
+        while (head < order.size()) {
+            size_t u = order[head++];
+            for (size_t a = g.firstArc[u]; a < g.firstArc[u + 1]; a++) {
+                if (!visited[g.arcs[a]]) {
+                    visited[g.arcs[a]] = true;
+                    order.push_back(g.arcs[a]);
+                }
+            }
+        }
+    }
+
+    return order;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+/** Grows the first part breadth first from a peripheral node, until it has half of the weight. */
+static std::vector<bool> growBisection(const tBisectionGraph& g)
+{
+    size_t totalWeight = 0;
+    for (size_t weight : g.nodeWeight) totalWeight += weight;
+
+    // the last node of a breadth first search is a good approximation of a peripheral node
+    size_t start = getBreadthFirstOrder(g, 0).back();
+    tIndices order = getBreadthFirstOrder(g, start);
+
+    std::vector<bool> side(g.getNumNodes(), true);
+    size_t weight = 0;
+    for (size_t i = 0; i < order.size() && 2 * weight < totalWeight; i++) {
+        side[order[i]] = false;
+        weight += g.nodeWeight[order[i]];
+    }
+
+    return side;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+/** Moves nodes to the other part, as long as this reduces the cut and keeps the balance. */
+static void refineBisection(const tBisectionGraph& g, std::vector<bool>& rSide)
+{
+    const size_t maxPasses = 8;
+
+    size_t sideWeight[2] = { 0, 0 };
+    for (size_t u = 0; u < g.getNumNodes(); u++) sideWeight[rSide[u]] += g.nodeWeight[u];
+    size_t maxWeight = (sideWeight[0] + sideWeight[1]) * 11 / 20;
+
+    bool moved = true;
+    for (size_t pass = 0; pass < maxPasses && moved; pass++) {
+        moved = false;
+        for (size_t u = 0; u < g.getNumNodes(); u++) {
+            size_t internal = 0;
+            size_t external = 0;
+            for (size_t a = g.firstArc[u]; a < g.firstArc[u + 1]; a++) {
+                if (rSide[g.arcs[a]] == rSide[u]) internal += g.arcWeight[a];
+                else external += g.arcWeight[a];
+            }
+
+            bool other = !rSide[u];
+            if (external > internal && sideWeight[other] + g.nodeWeight[u] <= maxWeight) {
+                sideWeight[rSide[u]] -= g.nodeWeight[u];
+                sideWeight[other] += g.nodeWeight[u];
+                rSide[u] = other;
+                moved = true;
+            }
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+/**
+* Multilevel bisection: the graph is coarsened until it is small, bisected and the bisection
+* is refined on each level while it is projected back to the original graph.
+*/
+static std::vector<bool> bisect(const tBisectionGraph& g)
+{
+    const size_t minNodes = 64;
+
+    tIndices coarseOf;
+    tBisectionGraph coarse;
+    if (g.getNumNodes() > minNodes) {
+        coarse = coarsen(g, coarseOf);
+    }
+
+    std::vector<bool> side;
+    // stop coarsening, if the graph is small or the matching makes no progress
+    if (g.getNumNodes() <= minNodes || 10 * coarse.getNumNodes() > 9 * g.getNumNodes()) {
+        side = growBisection(g);
+    }
+    else {
+        std::vector<bool> coarseSide = bisect(coarse);
+        side.resize(g.getNumNodes());
+        for (size_t u = 0; u < g.getNumNodes(); u++) side[u] = coarseSide[coarseOf[u]];
+    }
+
+    refineBisection(g, side);
+    return side;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Overlay::Overlay(const std::shared_ptr<const GraphSnapshot>& pSnapshot, std::vector<size_t> cellSizes,
+        size_t numThreads)
+    : m_pSnapshot(pSnapshot), m_pPartition(createPartition(*pSnapshot, cellSizes))
+{
+    customize(tMetric(), numThreads);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Overlay::Overlay(const Overlay& rPartition, const tMetric& metric, size_t numThreads)
+    : m_pSnapshot(rPartition.m_pSnapshot), m_pPartition(rPartition.m_pPartition)
+{
+    customize(metric, numThreads);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+std::shared_ptr<const Overlay::tPartition> Overlay::createPartition(const GraphSnapshot& rSnapshot,
+        std::vector<size_t> cellSizes)
+{
+    size_t numNodes = rSnapshot.getNumNodes();
+
+    // a cell must contain at least one node, otherwise the partition would never end
+    if (std::find(cellSizes.begin(), cellSizes.end(), 0) != cellSizes.end()) {
+        throw Graph::Exception("the cell sizes of an overlay must be positive");
+    }
+
+    std::shared_ptr<tPartition> pPartition = std::make_shared<tPartition>();
+    tPartition& rPartition = *pPartition;
+    rPartition.cellSizes.assign(cellSizes.begin(), cellSizes.end());
+    std::sort(rPartition.cellSizes.begin(), rPartition.cellSizes.end());
+    rPartition.levels.resize(rPartition.cellSizes.size());
+    for (tLevel& rLevel : rPartition.levels) rLevel.cellOf.assign(numNodes, 0);
+
+    if (!rPartition.levels.empty() && numNodes > 0) {
+        // the partition ignores the direction of the edges
+        tIndices firstNeighbour(numNodes + 1, 0);
+        for (size_t u = 0; u < numNodes; u++) {
+            for (size_t a = rSnapshot.m_firstArc[u]; a < rSnapshot.m_firstArc[u + 1]; a++) {
+                firstNeighbour[u + 1] += 1;
+                firstNeighbour[rSnapshot.m_arcs[a].dst + 1] += 1;
+            }
+        }
+        for (size_t u = 0; u < numNodes; u++) firstNeighbour[u + 1] += firstNeighbour[u];
+
+        tIndices neighbours(firstNeighbour.back());
+        tIndices next(firstNeighbour.begin(), firstNeighbour.end() - 1);
+        for (size_t u = 0; u < numNodes; u++) {
+            for (size_t a = rSnapshot.m_firstArc[u]; a < rSnapshot.m_firstArc[u + 1]; a++) {
+                size_t v = rSnapshot.m_arcs[a].dst;
+                neighbours[next[u]++] = v;
+                neighbours[next[v]++] = u;
+            }
+        }
+
+        tIndices nodes(numNodes);
+        for (size_t u = 0; u < numNodes; u++) nodes[u] = u;
+        tIndices localIndex(numNodes, numNodes);
+        tIndices numCells(rPartition.levels.size(), 0);
+        partition(rPartition, nodes, std::numeric_limits<size_t>::max(), firstNeighbour, neighbours,
+            localIndex, numCells);
+    }
+
+    findBoundaries(rSnapshot, rPartition);
+    return pPartition;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void Overlay::partition(tPartition& rPartition, tIndices& rNodes, size_t parentSize,
+        const tIndices& firstNeighbour, const tIndices& neighbours, tIndices& rLocalIndex, tIndices& rNumCells)
+{
+    const tIndices& cellSizes = rPartition.cellSizes;
+
+    // the nodes form a cell on each level, whose cells are larger than the parent part
+    for (size_t l = 0; l < rPartition.levels.size(); l++) {
+        if (rNodes.size() <= cellSizes[l] && parentSize > cellSizes[l]) {
+            for (size_t u : rNodes) rPartition.levels[l].cellOf[u] = rNumCells[l];
+            rNumCells[l] += 1;
+        }
+    }
+
+    if (rNodes.size() <= cellSizes.front()) {
+        return;
+    }
+
+    // build the subgraph of the nodes
+    tBisectionGraph g;
+    for (size_t i = 0; i < rNodes.size(); i++) rLocalIndex[rNodes[i]] = i;
+    g.nodeWeight.assign(rNodes.size(), 1);
+    g.firstArc.push_back(0);
+    for (size_t u : rNodes) {
+        for (size_t n = firstNeighbour[u]; n < firstNeighbour[u + 1]; n++) {
+            // the local index may be left over from another part
+            size_t v = rLocalIndex[neighbours[n]];
+            if (v < rNodes.size() && rNodes[v] == neighbours[n]) {
+                g.arcs.push_back(v);
+                g.arcWeight.push_back(1);
+            }
+        }
+        g.firstArc.push_back(g.arcs.size());
+    }
+
+    std::vector<bool> side = bisect(g);
+
+    tIndices parts[2];
+    for (size_t i = 0; i < rNodes.size(); i++) parts[side[i]].push_back(rNodes[i]);
+    if (parts[0].empty() || parts[1].empty()) {
+        // the bisection failed, just split the nodes
+        parts[0].assign(rNodes.begin(), rNodes.begin() + rNodes.size() / 2);
+        parts[1].assign(rNodes.begin() + rNodes.size() / 2, rNodes.end());
+    }
+
+    size_t size = rNodes.size();
+    tIndices().swap(rNodes);
+    partition(rPartition, parts[0], size, firstNeighbour, neighbours, rLocalIndex, rNumCells);
+    partition(rPartition, parts[1], size, firstNeighbour, neighbours, rLocalIndex, rNumCells);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void Overlay::findBoundaries(const GraphSnapshot& rSnapshot, tPartition& rPartition)
+{
+    size_t numNodes = rSnapshot.getNumNodes();
+
+    for (tLevel& rLevel : rPartition.levels) {
+        size_t numCells = 0;
+        for (size_t cell : rLevel.cellOf) numCells = std::max(numCells, cell + 1);
+
+        // a node is a boundary node, if it has an edge from or to another cell
+        std::vector<bool> isBoundary(numNodes, false);
+        for (size_t u = 0; u < numNodes; u++) {
+            for (size_t a = rSnapshot.m_firstArc[u]; a < rSnapshot.m_firstArc[u + 1]; a++) {
+                size_t v = rSnapshot.m_arcs[a].dst;
+                if (rLevel.cellOf[u] != rLevel.cellOf[v]) {
+                    isBoundary[u] = true;
+                    isBoundary[v] = true;
+                }
+            }
+        }
+
+        rLevel.firstBoundary.assign(numCells + 1, 0);
+        for (size_t u = 0; u < numNodes; u++) {
+            if (isBoundary[u]) rLevel.firstBoundary[rLevel.cellOf[u] + 1] += 1;
+        }
+        for (size_t c = 0; c < numCells; c++) rLevel.firstBoundary[c + 1] += rLevel.firstBoundary[c];
+
+        rLevel.boundary.resize(rLevel.firstBoundary.back());
+        rLevel.boundaryPos.assign(numNodes, numNodes);
+        tIndices next(rLevel.firstBoundary.begin(), rLevel.firstBoundary.end() - 1);
+        for (size_t u = 0; u < numNodes; u++) {
+            if (isBoundary[u]) {
+                size_t cell = rLevel.cellOf[u];
+                rLevel.boundaryPos[u] = next[cell] - rLevel.firstBoundary[cell];
+                rLevel.boundary[next[cell]++] = u;
+            }
+        }
+
+        // each cell has a square matrix of the distances between its boundary nodes
+        rLevel.firstClique.assign(numCells + 1, 0);
+        for (size_t c = 0; c < numCells; c++) {
+            size_t size = rLevel.firstBoundary[c + 1] - rLevel.firstBoundary[c];
+            rLevel.firstClique[c + 1] = rLevel.firstClique[c] + size * size;
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+size_t Overlay::getCell(size_t level, const Node& rNode) const
+{
+    return getLevel(level).cellOf[m_pSnapshot->getIndex(rNode)];
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+size_t Overlay::getMemoryUsage() const
+{
+    // a shared partition is counted by each overlay
+    size_t usage = sizeof(Overlay) + sizeof(tPartition) + m_pPartition->cellSizes.capacity() * sizeof(size_t);
+    for (const tLevel& rLevel : m_pPartition->levels) {
+        usage += sizeof(tLevel)
+            + (rLevel.cellOf.capacity() + rLevel.boundaryPos.capacity() + rLevel.firstBoundary.capacity()
+               + rLevel.boundary.capacity() + rLevel.firstClique.capacity()) * sizeof(size_t);
+    }
+
+    std::shared_ptr<const tMetricData> pMetric = std::atomic_load(&m_pMetric);
+    usage += sizeof(tMetricData) + pMetric->weights.capacity() * sizeof(double);
+    for (const std::vector<double>& rCliques : pMetric->cliques) {
+        usage += sizeof(rCliques) + rCliques.capacity() * sizeof(double);
+    }
+    return usage;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void Overlay::customize(const tMetric& metric, size_t numThreads)
+{
+    const GraphSnapshot& rSnapshot = *m_pSnapshot;
+    std::lock_guard<std::mutex> lock(m_customizeMutex);
+
+    // the new cliques are built aside, queries still use the current ones meanwhile
+    std::shared_ptr<tMetricData> pMetric = std::make_shared<tMetricData>();
+    tMetricData& rMetric = *pMetric;
+
+    rMetric.weights.resize(rSnapshot.m_arcs.size());
+    for (size_t a = 0; a < rMetric.weights.size(); a++) {
+        rMetric.weights[a] = metric ? metric(*rSnapshot.m_arcEdges[a]) : rSnapshot.m_arcs[a].weight;
+    }
+
+    rMetric.cliques.resize(getNumLevels());
+    for (size_t level = 1; level <= getNumLevels(); level++) {
+        rMetric.cliques[level - 1].resize(getLevel(level).firstClique.back());
+    }
+
+    // the cliques of a level are built from the level below, but the cells are independent
+    for (size_t level = 1; level <= getNumLevels(); level++) {
+        parallelFor(numThreads, getNumCells(level), [&](size_t, size_t begin, size_t end) {
+            GraphSnapshot::Workspace workspace;
+            for (size_t cell = begin; cell < end; cell++) {
+                customizeCell(level, cell, rMetric, workspace);
+            }
+        });
+    }
+
+    std::atomic_store(&m_pMetric, std::shared_ptr<const tMetricData>(pMetric));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void Overlay::customizeCell(size_t level, size_t cell, tMetricData& rMetric,
+        GraphSnapshot::Workspace& rWorkspace) const
+{
+    const tLevel& rLevel = getLevel(level);
+    size_t first = rLevel.firstBoundary[cell];
+    size_t size = rLevel.firstBoundary[cell + 1] - first;
+    double* pClique = rMetric.cliques[level - 1].data() + rLevel.firstClique[cell];
+
+    for (size_t i = 0; i < size; i++) {
+        searchInCell(rLevel.boundary[first + i], m_pSnapshot->getNumNodes(), level, rMetric, rWorkspace);
+        for (size_t j = 0; j < size; j++) {
+            pClique[i * size + j] = rWorkspace.getDistance(rLevel.boundary[first + j]);
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+template<class F>
+void Overlay::forEachArc(size_t node, size_t level, const tMetricData& rMetric, F f) const
+{
+    const GraphSnapshot& rSnapshot = *m_pSnapshot;
+    size_t firstArc = rSnapshot.m_firstArc[node];
+    size_t lastArc = rSnapshot.m_firstArc[node + 1];
+
+    if (level == 0) {
+        for (size_t a = firstArc; a < lastArc; a++) {
+            f(rSnapshot.m_arcs[a].dst, rMetric.weights[a], a);
+        }
+        return;
+    }
+
+    const tLevel& rLevel = getLevel(level);
+    size_t cell = rLevel.cellOf[node];
+
+    // the clique arcs to the other boundary nodes of the cell
+    size_t first = rLevel.firstBoundary[cell];
+    size_t size = rLevel.firstBoundary[cell + 1] - first;
+    const double* pRow = &rMetric.cliques[level - 1][rLevel.firstClique[cell] + rLevel.boundaryPos[node] * size];
+    for (size_t j = 0; j < size; j++) {
+        if (pRow[j] < std::numeric_limits<double>::max() && rLevel.boundary[first + j] != node) {
+            f(rLevel.boundary[first + j], pRow[j], rSnapshot.m_arcs.size() + level);
+        }
+    }
+
+    // the edges to other cells
+    for (size_t a = firstArc; a < lastArc; a++) {
+        if (rLevel.cellOf[rSnapshot.m_arcs[a].dst] != cell) {
+            f(rSnapshot.m_arcs[a].dst, rMetric.weights[a], a);
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void Overlay::searchInCell(size_t src, size_t dst, size_t level, const tMetricData& rMetric,
+        GraphSnapshot::Workspace& rWorkspace) const
+{
+    size_t numNodes = m_pSnapshot->getNumNodes();
+    const tLevel& rLevel = getLevel(level);
+    size_t cell = rLevel.cellOf[src];
+    size_t numBoundaryLeft = rLevel.firstBoundary[cell + 1] - rLevel.firstBoundary[cell];
+
+    GraphSnapshot::Workspace& w = rWorkspace;
+    w.reset(numNodes);
+    w.update(src, 0, numNodes, 0);
+    w.push(0, src);
+
+    while (!w.m_queue.empty()) {
+        GraphSnapshot::Workspace::tQueueEntry top = w.pop();
+
+        size_t u = top.second;
+        // skip outdated queue entries
+        if (top.first > w.m_distance[u]) {
+            continue;
+        }
+
+        if (u == dst) {
+            break;
+        }
+        if (dst == numNodes && rLevel.boundaryPos[u] != numNodes && --numBoundaryLeft == 0) {
+            break;
+        }
+
+        forEachArc(u, level - 1, rMetric, [&](size_t v, double weight, size_t arc) {
+            double newDistance = w.m_distance[u] + weight;
+            if (rLevel.cellOf[v] == cell && newDistance < w.getDistance(v)) {
+                w.update(v, newDistance, u, arc);
+                w.push(newDistance, v);
+            }
+        });
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+size_t Overlay::getQueryLevel(size_t node, size_t src, size_t dst) const
+{
+    // the cells are nested, so the node is also separated from src and dst on all lower levels
+    for (size_t level = getNumLevels(); level > 0; level--) {
+        const tIndices& cellOf = getLevel(level).cellOf;
+        if (cellOf[node] != cellOf[src] && cellOf[node] != cellOf[dst]) {
+            return level;
+        }
+    }
+
+    return 0;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Overlay::tPath Overlay::findShortestPath(const Node& rSrc, const Node& rDst) const
+{
+    GraphSnapshot::Workspace workspace;
+    return findShortestPath(rSrc, rDst, workspace);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Overlay::tPath Overlay::findShortestPath(const Node& rSrc, const Node& rDst,
+        GraphSnapshot::Workspace& rWorkspace) const
+{
+    size_t numNodes = m_pSnapshot->getNumNodes();
+    size_t src = m_pSnapshot->getIndex(rSrc);
+    size_t dst = m_pSnapshot->getIndex(rDst);
+
+    // keep the cliques alive, even if a customization replaces them meanwhile
+    std::shared_ptr<const tMetricData> pMetric = std::atomic_load(&m_pMetric);
+
+    GraphSnapshot::Workspace& w = rWorkspace;
+    w.reset(numNodes);
+    w.update(src, 0, numNodes, 0);
+    w.push(0, src);
+
+    while (!w.m_queue.empty()) {
+        GraphSnapshot::Workspace::tQueueEntry top = w.pop();
+
+        size_t u = top.second;
+        // skip outdated queue entries
+        if (top.first > w.m_distance[u]) {
+            continue;
+        }
+
+        if (u == dst) {
+            break;
+        }
+
+        // cells that contain neither src nor dst are skipped by their cliques
+        forEachArc(u, getQueryLevel(u, src, dst), *pMetric, [&](size_t v, double weight, size_t arc) {
+            double newDistance = w.m_distance[u] + weight;
+            if (newDistance < w.getDistance(v)) {
+                w.update(v, newDistance, u, arc);
+                w.push(newDistance, v);
+            }
+        });
+    }
+
+    tPath path;
+    if (w.isReached(dst)) {
+        unpackPath(src, dst, *pMetric, w, path);
+    }
+
+    return path;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void Overlay::unpack(size_t src, size_t dst, size_t arc, const tMetricData& rMetric,
+        GraphSnapshot::Workspace& rWorkspace, tPath& rPath) const
+{
+    size_t numArcs = m_pSnapshot->m_arcs.size();
+    if (arc < numArcs) {
+        rPath.push_back(m_pSnapshot->m_arcEdges[arc]);
+        return;
+    }
+
+    // a clique arc is a path inside its cell on the level below
+    searchInCell(src, dst, arc - numArcs, rMetric, rWorkspace);
+    unpackPath(src, dst, rMetric, rWorkspace, rPath);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void Overlay::unpackPath(size_t src, size_t dst, const tMetricData& rMetric,
+        GraphSnapshot::Workspace& rWorkspace, tPath& rPath) const
+{
+    // the workspace is reused by the recursion, so the arcs are copied first
+    std::vector<std::pair<size_t, size_t>> arcs;
+    for (size_t node = dst; node != src; node = rWorkspace.m_prevNode[node]) {
+        arcs.push_back(std::make_pair(node, rWorkspace.m_prevArc[node]));
+    }
+
+    size_t from = src;
+    for (auto it = arcs.rbegin(); it != arcs.rend(); it++) {
+        unpack(from, it->first, it->second, rMetric, rWorkspace, rPath);
+        from = it->first;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,197 @@
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <functional>
+#include <mutex>
+
+#include "GraphSnapshot.h"
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* A multi-level overlay for customizable route planning.
+* The nodes of a snapshot are partitioned into cells on several nested levels. For each cell,
+* the shortest distances between its boundary nodes are stored as a clique. A query only
+* enters the cells of the source and the destination and skips all other cells by their cliques.
+* The partition only depends on the topology. The cliques depend on the edge weights and are
+* recalculated by customize() in parallel, e.g. to switch between vehicle profiles.
+* Queries can run concurrently with customize(): they use the cliques, that were complete when
+* they started. Overlays for several metrics at once can share one partition.
+*/
+class Overlay
+{
+
+public:
+
+    //! @Datataypes
+
+    typedef GraphSnapshot::tPath tPath;
+
+    /** Returns the weight of an edge, e.g. for a vehicle profile. */
+    typedef std::function<double(const Edge&)> tMetric;
+
+
+public:
+
+    //! @Lifetime
+
+    /**
+    * Partitions the snapshot and customizes the overlay with the weights of the snapshot.
+    * @param pSnapshot the graph. The overlay keeps the snapshot alive.
+    * @param cellSizes the maximal number of nodes of a cell on each level. The lowest level
+    *        has the smallest cells, e.g. { 256, 4096, 65536 }.
+    * @param numThreads the number of threads for the customization.
+    * @throw Graph::Exception if a cell size is 0.
+    */
+    Overlay(const std::shared_ptr<const GraphSnapshot>& pSnapshot, std::vector<size_t> cellSizes,
+        size_t numThreads = std::thread::hardware_concurrency());
+
+    /**
+    * Creates an overlay with the partition of another overlay and customizes it for a metric.
+    * The partition is shared, so only the customization runs, e.g. for a second vehicle profile.
+    */
+    Overlay(const Overlay& rPartition, const tMetric& metric,
+        size_t numThreads = std::thread::hardware_concurrency());
+
+    Overlay(const Overlay&) = delete;
+    Overlay& operator=(const Overlay&) = delete;
+
+    /**
+    * Recalculates the cliques of all cells with new edge weights. The partition is kept.
+    * The cells of a level are customized in parallel. The new cliques are built aside and
+    * replace the old ones at once, so concurrent queries are not disturbed.
+    * Calls of customize() are serialized.
+    * @param metric returns the new weight of an edge. If not set, the weights of the snapshot are used.
+    */
+    void customize(const tMetric& metric = tMetric(), size_t numThreads = std::thread::hardware_concurrency());
+
+
+    //! @Overlay Information
+
+    const std::shared_ptr<const GraphSnapshot>& getSnapshot() const { return m_pSnapshot; }
+
+    /** The number of levels, without the level 0 of the original graph. */
+    size_t getNumLevels() const { return m_pPartition->levels.size(); }
+
+    /** @param level between 1 and getNumLevels(). */
+    size_t getNumCells(size_t level) const { return getLevel(level).firstBoundary.size() - 1; }
+
+    /** @return the cell of the node on the given level. */
+    size_t getCell(size_t level, const Node& rNode) const;
+
+    /** The memory of the partition, the cliques and the metric in bytes, without the snapshot. */
+    size_t getMemoryUsage() const;
+
+
+    //! @Routing
+
+    /**
+    * Calculate the shortest path from a source node to a destination node with the weights of
+    * the last customization.
+    * @throw Graph::InvalidNodeException if a node is not part of the snapshot.
+    */
+    tPath findShortestPath(const Node& rSrc, const Node& rDst) const;
+
+    /** Calculate the shortest path like above, but reuse the memory of the given workspace. */
+    tPath findShortestPath(const Node& rSrc, const Node& rDst, GraphSnapshot::Workspace& rWorkspace) const;
+
+
+private:
+
+    typedef std::vector<size_t> tIndices;
+
+    // the cells of one level and their boundary nodes
+    struct tLevel
+    {
+        tIndices cellOf;            // the cell of each node
+        tIndices boundaryPos;       // the position of each node in the boundary of its cell
+        tIndices firstBoundary;     // the boundary of cell c is boundary[firstBoundary[c]] ..
+        tIndices boundary;
+        tIndices firstClique;       // the clique of cell c starts at clique[firstClique[c]]
+    };
+
+    // the metric independent part of the overlay
+    struct tPartition
+    {
+        tIndices cellSizes;
+        std::vector<tLevel> levels;
+    };
+
+    // the result of a customization
+    struct tMetricData
+    {
+        std::vector<double> weights;            // the weight of each arc of the snapshot
+        std::vector<std::vector<double>> cliques; // per level the row-major distance matrices
+                                                  // between the boundary nodes of each cell
+    };
+
+    const tLevel& getLevel(size_t level) const { return m_pPartition->levels[level - 1]; }
+
+    /** Partitions the snapshot and finds the boundary nodes. */
+    static std::shared_ptr<const tPartition> createPartition(const GraphSnapshot& rSnapshot,
+        std::vector<size_t> cellSizes);
+
+    /**
+    * Recursive bisection of the nodes, until the cells are small enough for all levels.
+    * @param rNumCells the number of cells on each level so far.
+    */
+    static void partition(tPartition& rPartition, tIndices& rNodes, size_t parentSize,
+        const tIndices& firstNeighbour, const tIndices& neighbours, tIndices& rLocalIndex, tIndices& rNumCells);
+
+    /** Finds the boundary nodes of all cells. */
+    static void findBoundaries(const GraphSnapshot& rSnapshot, tPartition& rPartition);
+
+    /** Calculates the cliques of a single cell. The levels below must be customized already. */
+    void customizeCell(size_t level, size_t cell, tMetricData& rMetric, GraphSnapshot::Workspace& rWorkspace) const;
+
+    /**
+    * Calls f(dst, weight, arc) for all arcs leaving node on the given level. On level 0 these are
+    * all edges, on higher levels the clique arcs of the node's cell and the edges to other cells.
+    * Clique arcs have the number of arcs + level as arc.
+    */
+    template<class F>
+    void forEachArc(size_t node, size_t level, const tMetricData& rMetric, F f) const;
+
+    /**
+    * Dijkstra's algorithm inside the cell of src on the given level. It uses the arcs of the
+    * level below, so it finds the paths that are represented by the clique of the cell.
+    * @param dst the search stops at this node. If it is the number of nodes, the search
+    *        stops as soon as all boundary nodes of the cell are settled.
+    */
+    void searchInCell(size_t src, size_t dst, size_t level, const tMetricData& rMetric,
+        GraphSnapshot::Workspace& rWorkspace) const;
+
+    /** Appends the edges of the (clique) arc from src to dst to the path. */
+    void unpack(size_t src, size_t dst, size_t arc, const tMetricData& rMetric,
+        GraphSnapshot::Workspace& rWorkspace, tPath& rPath) const;
+
+    /** Appends the edges of the path from src to dst, that the workspace contains, to the path. */
+    void unpackPath(size_t src, size_t dst, const tMetricData& rMetric,
+        GraphSnapshot::Workspace& rWorkspace, tPath& rPath) const;
+
+    /** The highest level on which the node is neither in the cell of src nor of dst. */
+    size_t getQueryLevel(size_t node, size_t src, size_t dst) const;
+
+    std::shared_ptr<const GraphSnapshot> m_pSnapshot;
+
+    // shared by all overlays, that were created from the same partition
+    std::shared_ptr<const tPartition> m_pPartition;
+
+    // replaced at once by customize(), queries keep the one they started with
+    std::shared_ptr<const tMetricData> m_pMetric;
+
+    std::mutex m_customizeMutex;
+
+#ifdef TESTING
+    friend class GraphTesting;
+#endif
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <vector>
+#include <thread>
+#include <exception>
+#include <algorithm>
+#include <cstddef>
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* Splits 0 .. size - 1 into one contiguous range per thread and calls f(thread, begin, end)
+* for each range in parallel. The calling thread takes the first range, and at most size
+* threads are used. Returns when all ranges are done.
+* If f throws, the exception is rethrown on the calling thread after all threads have ended.
+* Of several exceptions, the one of the first range is thrown.
+*/
+template<class F>
+void parallelFor(size_t numThreads, size_t size, F f)
+{
+    numThreads = std::max<size_t>(1, std::min(numThreads, size));
+
+    // an exception must not leave a thread, that would terminate the process
+    std::vector<std::exception_ptr> errors(numThreads);
+    auto run = [&](size_t t) {
+        try {
+            f(t, size * t / numThreads, size * (t + 1) / numThreads);
+        }
+        catch (...) {
+            errors[t] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numThreads; t++) {
+        threads.push_back(std::thread(run, t));
+    }
+    run(0);
+
+    for (std::thread& thread : threads) thread.join();
+
+    for (const std::exception_ptr& pError : errors) {
+        if (pError) std::rethrow_exception(pError);
+    }
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,197 @@
+#include "QueryExecutor.h"
+
+#include <algorithm>
+
+
+//-------------------------------------------------------------------------------------------------
+
+QueryExecutor::QueryExecutor(size_t numWorkers)
+    : m_numPending(0), m_nextWorker(0), m_stop(false)
+{
+    // hardware_concurrency() may return 0
+    numWorkers = std::max<size_t>(numWorkers, 1);
+
+    for (size_t i = 0; i < numWorkers; i++) {
+        m_workers.push_back(std::unique_ptr<tWorker>(new tWorker()));
+    }
+
+    // start the threads after all workers exist, since they steal from each other
+    for (size_t i = 0; i < numWorkers; i++) {
+        m_workers[i]->thread = std::thread(&QueryExecutor::run, this, i);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+QueryExecutor::~QueryExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wakeUp.notify_all();
+
+    for (auto& pWorker : m_workers) {
+        pWorker->thread.join();
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+std::future<QueryExecutor::tPath> QueryExecutor::submit(
+        const std::shared_ptr<const GraphSnapshot>& pSnapshot, const Node& rSrc, const Node& rDst,
+        const CancelToken& rToken, tTimePoint deadline)
+{
+    std::future<tPath> future;
+    std::vector<tTask> tasks(1, makeTask(pSnapshot, rSrc, rDst, rToken, deadline, future));
+    push(tasks);
+    return future;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+std::future<QueryExecutor::tPath> QueryExecutor::submit(
+        const std::shared_ptr<const GraphSnapshot>& pSnapshot, const Node& rSrc, const Node& rDst,
+        tTimePoint deadline)
+{
+    return submit(pSnapshot, rSrc, rDst, CancelToken(), deadline);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+std::vector<std::future<QueryExecutor::tPath>> QueryExecutor::submitBatch(
+        const std::shared_ptr<const GraphSnapshot>& pSnapshot, const std::vector<tQuery>& queries,
+        const CancelToken& rToken, tTimePoint deadline)
+{
+    std::vector<std::future<tPath>> futures(queries.size());
+    std::vector<tTask> tasks;
+    tasks.reserve(queries.size());
+
+    for (size_t i = 0; i < queries.size(); i++) {
+        tasks.push_back(makeTask(pSnapshot, *queries[i].first, *queries[i].second, rToken, deadline, futures[i]));
+    }
+
+    push(tasks);
+    return futures;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+QueryExecutor::tTask QueryExecutor::makeTask(const std::shared_ptr<const GraphSnapshot>& pSnapshot,
+        const Node& rSrc, const Node& rDst, const CancelToken& rToken, tTimePoint deadline,
+        std::future<tPath>& rFuture)
+{
+    // std::function must be copyable, so the promise is shared
+    auto pPromise = std::make_shared<std::promise<tPath>>();
+    rFuture = pPromise->get_future();
+
+    const Node* pSrc = &rSrc;
+    const Node* pDst = &rDst;
+    CancelToken token = rToken;
+
+    return [=](GraphSnapshot::Workspace& rWorkspace) {
+        auto isAborted = [&]() {
+            return token.isCancelled() || std::chrono::steady_clock::now() >= deadline;
+        };
+
+        try {
+            // the query might have waited in the queue for too long
+            if (isAborted()) {
+                throw Graph::AbortedException("query aborted before it was started");
+            }
+            pPromise->set_value(pSnapshot->findShortestPathDijkstra(*pSrc, *pDst, rWorkspace, isAborted));
+        }
+        catch (...) {
+            pPromise->set_exception(std::current_exception());
+        }
+    };
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void QueryExecutor::push(std::vector<tTask>& tasks)
+{
+    {
+        // the lock ensures, that no worker misses the notification between its check and wait.
+        // Count first, so that the counter never drops below zero.
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_numPending += tasks.size();
+    }
+
+    size_t first = m_nextWorker.fetch_add(tasks.size());
+    for (size_t i = 0; i < tasks.size(); i++) {
+        tWorker& rWorker = *m_workers[(first + i) % m_workers.size()];
+        std::lock_guard<std::mutex> lock(rWorker.mutex);
+        rWorker.tasks.push_back(std::move(tasks[i]));
+    }
+
+    if (tasks.size() == 1) {
+        m_wakeUp.notify_one();
+    }
+    else {
+        m_wakeUp.notify_all();
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool QueryExecutor::pop(size_t workerIndex, tTask& rTask)
+{
+    // the own queue is processed in the order of submission, so the first queries of a batch
+    // are not delayed by the later ones
+    for (size_t i = 0; i < m_workers.size(); i++) {
+        tWorker& rWorker = *m_workers[(workerIndex + i) % m_workers.size()];
+        std::lock_guard<std::mutex> lock(rWorker.mutex);
+        if (rWorker.tasks.empty()) {
+            continue;
+        }
+
+        if (i == 0) {
+            rTask = std::move(rWorker.tasks.front());
+            rWorker.tasks.pop_front();
+        }
+        else {
+            // steal the newest task of another worker, its owner takes the oldest ones
+            rTask = std::move(rWorker.tasks.back());
+            rWorker.tasks.pop_back();
+        }
+        m_numPending -= 1;
+        return true;
+    }
+
+    return false;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void QueryExecutor::run(size_t workerIndex)
+{
+    tWorker& rWorker = *m_workers[workerIndex];
+    tTask task;
+
+    while (true) {
+        if (pop(workerIndex, task)) {
+            task(rWorker.workspace);
+            // release the snapshot of the query
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeUp.wait(lock, [this]() { return m_stop || m_numPending > 0; });
+        if (m_stop && m_numPending == 0) {
+            return;
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,140 @@
+#ifndef QUERYEXECUTOR_H
+#define QUERYEXECUTOR_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+#include "GraphSnapshot.h"
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* Runs routing queries asynchronously on a pool of worker threads.
+* Each worker has its own task queue and search workspace. Idle workers steal tasks from the
+* queues of the other workers. The results are delivered as futures.
+*/
+class QueryExecutor
+{
+
+public:
+
+    //! @Datataypes
+
+    typedef GraphSnapshot::tPath tPath;
+    typedef std::chrono::steady_clock::time_point tTimePoint;
+    typedef std::pair<const Node*, const Node*> tQuery;
+
+    class CancelToken;
+
+
+public:
+
+    //! @Lifetime
+
+    /** Starts the worker threads. By default, one worker per core is used. */
+    QueryExecutor(size_t numWorkers = std::thread::hardware_concurrency());
+
+    /** Finishes all submitted queries and stops the worker threads. */
+    virtual ~QueryExecutor();
+
+    QueryExecutor(const QueryExecutor&) = delete;
+    QueryExecutor& operator=(const QueryExecutor&) = delete;
+
+    size_t getNumWorkers() const { return m_workers.size(); }
+
+
+    //! @Queries
+
+    /**
+    * Calculates the shortest path from rSrc to rDst on the given snapshot asynchronously.
+    * @param rToken cancels the query, even if the search is already running.
+    * @param deadline the query is aborted, if it is not finished at this point in time.
+    * @return the future path. It throws Graph::AbortedException if the query was cancelled
+    *         or the deadline has passed, and Graph::InvalidNodeException for unknown nodes.
+    */
+    std::future<tPath> submit(const std::shared_ptr<const GraphSnapshot>& pSnapshot,
+        const Node& rSrc, const Node& rDst,
+        const CancelToken& rToken, tTimePoint deadline = tTimePoint::max());
+
+    std::future<tPath> submit(const std::shared_ptr<const GraphSnapshot>& pSnapshot,
+        const Node& rSrc, const Node& rDst, tTimePoint deadline = tTimePoint::max());
+
+    /**
+    * Submits several queries at once. The queries are distributed over all workers.
+    * @return the future paths in the order of the queries.
+    */
+    std::vector<std::future<tPath>> submitBatch(const std::shared_ptr<const GraphSnapshot>& pSnapshot,
+        const std::vector<tQuery>& queries,
+        const CancelToken& rToken, tTimePoint deadline = tTimePoint::max());
+
+
+private:
+
+    typedef std::function<void(GraphSnapshot::Workspace&)> tTask;
+
+    struct tWorker
+    {
+        std::mutex mutex;
+        std::deque<tTask> tasks;
+        GraphSnapshot::Workspace workspace;
+        std::thread thread;
+    };
+
+    /** Creates the task for a single query. */
+    tTask makeTask(const std::shared_ptr<const GraphSnapshot>& pSnapshot, const Node& rSrc,
+        const Node& rDst, const CancelToken& rToken, tTimePoint deadline, std::future<tPath>& rFuture);
+
+    /** Adds the tasks to the worker queues in round robin order and wakes up the workers. */
+    void push(std::vector<tTask>& tasks);
+
+    /** Takes a task from the own queue or steals one from another worker. */
+    bool pop(size_t workerIndex, tTask& rTask);
+
+    void run(size_t workerIndex);
+
+    std::vector<std::unique_ptr<tWorker>> m_workers;
+
+    // the number of tasks in all queues
+    std::atomic<size_t> m_numPending;
+    std::atomic<size_t> m_nextWorker;
+
+    // idle workers wait for new tasks
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    bool m_stop;
+
+#ifdef TESTING
+    friend class GraphTesting;
+#endif
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/** Cancels all queries that were submitted with this token or a copy of it. */
+class QueryExecutor::CancelToken
+{
+public:
+    CancelToken() : m_pCancelled(std::make_shared<std::atomic<bool>>(false)) { }
+
+    void cancel() { *m_pCancelled = true; }
+
+    bool isCancelled() const { return *m_pCancelled; }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_pCancelled;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
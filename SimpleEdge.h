@@ -11,6 +11,8 @@ public:
 
     virtual double getWeight() const { return m_weight; }
 
+    virtual size_t getMemoryUsage() const { return sizeof(SimpleEdge); }
+
 private:
     double m_weight;
 };
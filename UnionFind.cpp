@@ -0,0 +1,60 @@
+#include "UnionFind.h"
+
+#include <algorithm>
+
+
+//-------------------------------------------------------------------------------------------------
+
+UnionFind::UnionFind(size_t size)
+    : m_parent(size)
+{
+    for (size_t i = 0; i < size; i++) {
+        m_parent[i].store(tIndex(i), std::memory_order_relaxed);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+size_t UnionFind::find(size_t element)
+{
+    tIndex current = tIndex(element);
+    while (true) {
+        tIndex parent = m_parent[current].load();
+        if (parent == current) {
+            return current;
+        }
+
+        // path halving: point to the grandparent. If another thread changed the parent
+        // in the meantime, the grandparent is still an ancestor, so the search goes on there.
+        tIndex grandParent = m_parent[parent].load();
+        if (grandParent != parent) {
+            m_parent[current].compare_exchange_weak(parent, grandParent);
+        }
+        current = grandParent;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool UnionFind::unite(size_t a, size_t b)
+{
+    while (true) {
+        tIndex rootA = tIndex(find(a));
+        tIndex rootB = tIndex(find(b));
+        if (rootA == rootB) {
+            return false;
+        }
+
+        // always link the smaller index below the larger one, so no cycles can arise.
+        // The CAS fails, if another thread linked rootA meanwhile, then retry with the new roots.
+        if (rootA > rootB) std::swap(rootA, rootB);
+        if (m_parent[rootA].compare_exchange_strong(rootA, rootB)) {
+            return true;
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,68 @@
+#ifndef UNIONFIND_H
+#define UNIONFIND_H
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* A lock-free union-find (disjoint set) structure for the elements 0 .. size - 1.
+* find() and unite() can be called from any number of threads at the same time. All changes
+* are single compare-and-swap operations, so no thread ever waits for another one.
+*/
+class UnionFind
+{
+
+public:
+
+    //! @Datataypes
+
+    // 32-bit indices, like the node indices of a snapshot
+    typedef std::uint32_t tIndex;
+
+
+public:
+
+    //! @Lifetime
+
+    /** Creates a set for each element. @param size at most the maximum of tIndex. */
+    explicit UnionFind(size_t size);
+
+    UnionFind(const UnionFind&) = delete;
+    UnionFind& operator=(const UnionFind&) = delete;
+
+
+    //! @Sets
+
+    size_t getSize() const { return m_parent.size(); }
+
+    /**
+    * @return the representative of the set of the element. It is only stable, as long as no
+    *         other thread unites the set concurrently.
+    */
+    size_t find(size_t element);
+
+    /**
+    * Unites the sets of both elements.
+    * @return true, if this call united them, false if they were in the same set already.
+    */
+    bool unite(size_t a, size_t b);
+
+
+private:
+
+    std::vector<std::atomic<tIndex>> m_parent;
+
+#ifdef TESTING
+    friend class GraphTesting;
+#endif
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
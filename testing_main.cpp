@@ -4,9 +4,20 @@
 
 #include "Graph.h"
 #include "SimpleEdge.h"
+#include "GraphSnapshot.h"
+#include "QueryExecutor.h"
+#include "Landmarks.h"
+#include "Overlay.h"
+#include "CompactGraph.h"
 
 #include <algorithm>
 #include <chrono>
+#include <thread>
+#include <atomic>
+#include <future>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
 
 
 /*-----------------------------------------------------------------------------------------------*/
@@ -22,6 +33,98 @@ double getExecutionSpeed(T func)
 }
 
 
+/*-----------------------------------------------------------------------------------------------*/
+
+/* A node with a geometric position. */
+class GeoNode : public Node
+{
+public:
+    GeoNode(std::string id, double x, double y) : Node(id), m_x(x), m_y(y) { }
+
+    virtual bool getCoordinates(double& rX, double& rY) const { rX = m_x; rY = m_y; return true; }
+
+private:
+    double m_x;
+    double m_y;
+};
+
+
+/* An edge, whose weight cannot be calculated. */
+class BrokenEdge : public Edge
+{
+public:
+    BrokenEdge(Node& src, Node& dst) : Edge(src, dst) { }
+
+    virtual double getWeight() const { throw Graph::Exception("no weight"); }
+};
+
+
+/*
+* Builds a width x width grid with bidirectional edges. The node ids are unrelated to the topology.
+* The weights are raised to the given exponent.
+*/
+std::vector<Node*> makeGrid(Graph& rGraph, size_t width, double exponent = 1)
+{
+    std::vector<Node*> nodes;
+    for (unsigned long long i = 0; i < width * width; i++) {
+        std::stringstream id;
+        id << std::setw(10) << std::setfill('0') << (i * 2654435761ULL) % 4294967291ULL;
+        nodes.push_back(&rGraph.makeNode(GeoNode(id.str(), double(i % width), double(i / width))));
+    }
+
+    // pseudo random weights, so that there are not too many shortest paths of the same length
+    for (unsigned long long i = 0; i < nodes.size(); i++) {
+        if (i % width + 1 < width) {
+            rGraph.makeBiEdge<SimpleEdge>(*nodes[i], *nodes[i + 1], pow(1 + (i * 2654435761ULL >> 8) % 16, exponent));
+        }
+        if (i + width < nodes.size()) {
+            rGraph.makeBiEdge<SimpleEdge>(*nodes[i], *nodes[i + width], pow(1 + (i * 40503ULL >> 4) % 16, exponent));
+        }
+    }
+
+    return nodes;
+}
+
+
+/*
+* Builds numClusters x numClusters grids of clusterWidth x clusterWidth nodes. Neighbouring clusters
+* are connected by a single pair of edges, so the graph has small separators like a road network.
+*/
+std::vector<Node*> makeClusters(Graph& rGraph, size_t numClusters, size_t clusterWidth)
+{
+    size_t width = numClusters * clusterWidth;
+    std::vector<Node*> nodes;
+    for (unsigned long long i = 0; i < width * width; i++) {
+        std::stringstream id;
+        id << std::setw(10) << std::setfill('0') << (i * 2654435761ULL) % 4294967291ULL;
+        nodes.push_back(&rGraph.makeNode(GeoNode(id.str(), double(i % width), double(i / width))));
+    }
+
+    for (unsigned long long i = 0; i < nodes.size(); i++) {
+        size_t x = i % width;
+        size_t y = i / width;
+        bool isRightBorder = (x + 1) % clusterWidth == 0;
+        bool isLowerBorder = (y + 1) % clusterWidth == 0;
+        if (x + 1 < width && (!isRightBorder || y % clusterWidth == clusterWidth / 2)) {
+            rGraph.makeBiEdge<SimpleEdge>(*nodes[i], *nodes[i + 1], double(1 + (i * 2654435761ULL >> 8) % 16));
+        }
+        if (y + 1 < width && (!isLowerBorder || x % clusterWidth == clusterWidth / 2)) {
+            rGraph.makeBiEdge<SimpleEdge>(*nodes[i], *nodes[i + width], double(1 + (i * 40503ULL >> 4) % 16));
+        }
+    }
+
+    return nodes;
+}
+
+
+double getPathWeight(const GraphSnapshot::tPath& path)
+{
+    double weight = 0;
+    for (Edge* pEdge : path) weight += pEdge->getWeight();
+    return weight;
+}
+
+
 /*-----------------------------------------------------------------------------------------------*/
 
 class GraphTesting {
@@ -88,6 +191,626 @@ public:
     }
 
 
+    /* TEST: Readers keep their snapshot, while the writer modifies the graph. */
+    void testSnapshot()
+    {
+        std::cout << "testSnapshot: ";
+
+        Graph h;
+        Node& rA = h.makeNode<Node>("A");
+        Node& rB = h.makeNode<Node>("B");
+        Node& rC = h.makeNode<Node>("C");
+        SimpleEdge& rAB = h.makeEdge<SimpleEdge>(rA, rB, 1);
+        h.makeEdge<SimpleEdge>(rB, rC, 1);
+
+        auto pOld = h.publishSnapshot();
+
+        // concurrent readers on the old snapshot
+        std::vector<std::thread> readers;
+        std::vector<size_t> pathLengths(4);
+        for (size_t i = 0; i < pathLengths.size(); i++) {
+            readers.push_back(std::thread([&, i]() {
+                pathLengths[i] = pOld->findShortestPathDijkstra(rA, rC).size();
+            }));
+        }
+
+        // the writer removes the first edge meanwhile
+        h.remove(rAB);
+        auto pNew = h.publishSnapshot();
+
+        for (std::thread& reader : readers) reader.join();
+
+        for (size_t length : pathLengths) {
+            if (length != 2) {
+                std::cout << "The old snapshot has changed!" << std::endl;
+                return;
+            }
+        }
+
+        if (!pNew->findShortestPathDijkstra(rA, rC).empty() || h.getSnapshot() != pNew
+                || pNew->getEpoch() != pOld->getEpoch() + 1) {
+            std::cout << "The new snapshot is wrong!" << std::endl;
+            return;
+        }
+
+        // publishing without removals does not extend the chain of retired objects
+        if (h.publishSnapshot()->m_pRetired != pNew->m_pRetired) {
+            std::cout << "The chain of retired objects has grown!" << std::endl;
+            return;
+        }
+
+        // a long chain behind a pinned snapshot is kept, and freed by the next publish after its release
+        Graph chain;
+        auto pPinned = chain.publishSnapshot();
+        for (size_t i = 0; i < 1000000; i++) {
+            chain.remove(chain.makeNode<Node>("n"));
+            chain.publishSnapshot();
+        }
+        size_t chainLength = chain.m_retired.size();
+        pPinned.reset();
+        chain.publishSnapshot();
+        if (chainLength != 1000001 || chain.m_retired.size() != 1) {
+            std::cout << "The retired objects were not freed!" << std::endl;
+            return;
+        }
+
+        // readers query the removed edges of their snapshots, while the writer removes and publishes
+        Graph stress;
+        Node& rFrom = stress.makeNode<Node>("from");
+        Node& rTo = stress.makeNode<Node>("to");
+        stress.makeEdge<SimpleEdge>(rFrom, stress.makeNode<Node>("via"), 1);
+        stress.makeEdge<SimpleEdge>(*stress.findNodeById("via"), rTo, 1);
+        stress.publishSnapshot();
+
+        std::atomic<bool> isDone(false);
+        std::atomic<size_t> numWrong(0);
+        readers.clear();
+        for (size_t i = 0; i < 4; i++) {
+            readers.push_back(std::thread([&]() {
+                while (!isDone) {
+                    // the edges of the path are only valid as long as the snapshot is held
+                    auto pSnapshot = stress.getSnapshot();
+                    auto path = pSnapshot->findShortestPathDijkstra(rFrom, rTo);
+                    if (path.size() != 2 || getPathWeight(path) != 2 || &path[0]->getDstNode() != &path[1]->getSrcNode()) {
+                        numWrong++;
+                    }
+                }
+            }));
+        }
+
+        for (size_t i = 0; i < 2000; i++) {
+            stress.remove(*stress.findNodeById("via"));
+            Node& rVia = stress.makeNode<Node>("via");
+            stress.makeEdge<SimpleEdge>(rFrom, rVia, 1);
+            stress.makeEdge<SimpleEdge>(rVia, rTo, 1);
+            stress.publishSnapshot();
+        }
+        isDone = true;
+        for (std::thread& reader : readers) reader.join();
+
+        if (numWrong > 0) {
+            std::cout << "Wrong paths while the writer removed nodes!" << std::endl;
+            return;
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
+    /* TEST: The node layout of a snapshot does not change lookups and path lengths. */
+    void testSnapshotOrder()
+    {
+        std::cout << "testSnapshotOrder: ";
+
+        Graph h;
+        std::vector<Node*> nodes = makeGrid(h, 20);
+
+        double expected = getPathWeight(h.publishSnapshot()->findShortestPathDijkstra(*nodes[0], *nodes.back()));
+
+        for (Graph::NodeOrder order : { Graph::ORDER_BFS, Graph::ORDER_DFS, Graph::ORDER_RCM, Graph::ORDER_HILBERT }) {
+            auto pSnapshot = h.publishSnapshot(order);
+            for (Node* pNode : nodes) {
+                if (pSnapshot->findNodeById(pNode->getId()) != pNode) {
+                    std::cout << "Node lookup failed for order " << order << "!" << std::endl;
+                    return;
+                }
+            }
+
+            auto path = pSnapshot->findShortestPathDijkstra(*nodes[0], *nodes.back());
+            if (getPathWeight(path) != expected || &path.front()->getSrcNode() != nodes[0]) {
+                std::cout << "Wrong path for order " << order << "!" << std::endl;
+                return;
+            }
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
+    /* TEST: Asynchronous queries have the same results as synchronous ones and can be aborted. */
+    void testQueryExecutor()
+    {
+        std::cout << "testQueryExecutor: ";
+
+        Graph h;
+        std::vector<Node*> nodes = makeGrid(h, 20);
+        auto pSnapshot = h.publishSnapshot();
+
+        std::vector<QueryExecutor::tQuery> queries;
+        for (size_t i = 0; i < 50; i++) {
+            queries.push_back(QueryExecutor::tQuery(nodes[i], nodes[nodes.size() - 1 - 3 * i]));
+        }
+
+        QueryExecutor executor(4);
+        auto futures = executor.submitBatch(pSnapshot, queries, QueryExecutor::CancelToken());
+        for (size_t i = 0; i < queries.size(); i++) {
+            auto expected = pSnapshot->findShortestPathDijkstra(*queries[i].first, *queries[i].second);
+            if (getPathWeight(futures[i].get()) != getPathWeight(expected)) {
+                std::cout << "Wrong path for query " << i << "!" << std::endl;
+                return;
+            }
+        }
+
+        // a single worker runs a batch in the order of submission
+        std::vector<size_t> order;
+        {
+            QueryExecutor single(1);
+            std::vector<QueryExecutor::tTask> tasks;
+            for (size_t i = 0; i < 40; i++) {
+                tasks.push_back([&order, i](GraphSnapshot::Workspace&) { order.push_back(i); });
+            }
+            single.push(tasks);
+        }
+        for (size_t i = 0; i < 40; i++) {
+            if (order.size() != 40 || order[i] != i) {
+                std::cout << "The batch was not run in the order of submission!" << std::endl;
+                return;
+            }
+        }
+
+        QueryExecutor::CancelToken token;
+        token.cancel();
+        auto cancelled = executor.submit(pSnapshot, *nodes[0], *nodes.back(), token);
+        auto expired = executor.submit(pSnapshot, *nodes[0], *nodes.back(), std::chrono::steady_clock::now());
+        for (auto* pFuture : { &cancelled, &expired }) {
+            try {
+                pFuture->get();
+                std::cout << "The query was not aborted!" << std::endl;
+                return;
+            }
+            catch (const Graph::AbortedException&) {
+            }
+        }
+
+        // a query cancelled while it waits behind a blocking task is never started
+        std::promise<void> gate;
+        std::shared_future<void> isOpen = gate.get_future().share();
+        {
+            QueryExecutor single(1);
+            std::vector<QueryExecutor::tTask> blocking(1, [isOpen](GraphSnapshot::Workspace&) { isOpen.wait(); });
+            single.push(blocking);
+
+            QueryExecutor::CancelToken queuedToken;
+            auto queued = single.submit(pSnapshot, *nodes[0], *nodes.back(), queuedToken);
+            queuedToken.cancel();
+            gate.set_value();
+            try {
+                queued.get();
+                std::cout << "The queued query was not aborted!" << std::endl;
+                return;
+            }
+            catch (const Graph::AbortedException& e) {
+                if (e.what() != "query aborted before it was started") {
+                    std::cout << "The queued query was started: " << e.what() << std::endl;
+                    return;
+                }
+            }
+        }
+
+        // a running search is aborted at its next check, here the first one after 256 nodes
+        size_t numChecks = 0;
+        try {
+            GraphSnapshot::Workspace workspace;
+            pSnapshot->findShortestPathDijkstra(*nodes[0], *nodes.back(), workspace, [&]() { return ++numChecks == 1; });
+            std::cout << "The running query was not aborted!" << std::endl;
+            return;
+        }
+        catch (const Graph::AbortedException& e) {
+            if (e.what() != "search aborted" || numChecks != 1) {
+                std::cout << "The query was not aborted while running: " << e.what() << std::endl;
+                return;
+            }
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
+    /* TEST: ALT finds paths as short as Dijkstra's, and the landmark bounds are lower bounds. */
+    void testLandmarks()
+    {
+        std::cout << "testLandmarks: ";
+
+        Graph h;
+        std::vector<Node*> nodes = makeGrid(h, 30);
+        // a one-way edge and an isolated node
+        h.makeEdge<SimpleEdge>(*nodes[5], *nodes[500], 0.5);
+        Node& rIsolated = h.makeNode<Node>("isolated");
+        auto pSnapshot = h.publishSnapshot(Graph::ORDER_RCM);
+
+        for (Landmarks::Selection selection : { Landmarks::SELECT_FARTHEST, Landmarks::SELECT_AVOID }) {
+            Landmarks landmarks(pSnapshot, 6, selection, 3);
+
+            for (size_t i = 0; i < 40; i++) {
+                Node& rSrc = *nodes[(i * 97) % nodes.size()];
+                Node& rDst = *nodes[(i * 389 + 11) % nodes.size()];
+                double expected = getPathWeight(pSnapshot->findShortestPathDijkstra(rSrc, rDst));
+                if (getPathWeight(landmarks.findShortestPath(rSrc, rDst)) != expected
+                        || landmarks.getLowerBound(rSrc, rDst) > expected) {
+                    std::cout << "Wrong path for selection " << selection << "!" << std::endl;
+                    return;
+                }
+            }
+
+            if (!landmarks.findShortestPath(*nodes[0], rIsolated).empty()
+                    || landmarks.getLandmarks().size() != 6) {
+                std::cout << "Wrong landmarks for selection " << selection << "!" << std::endl;
+                return;
+            }
+        }
+
+        // distances beyond the float range are still reachable
+        Graph huge;
+        Node& rA = huge.makeNode<Node>("A");
+        Node& rB = huge.makeNode<Node>("B");
+        Node& rC = huge.makeNode<Node>("C");
+        huge.makeBiEdge<SimpleEdge>(rA, rB, 1e39);
+        huge.makeBiEdge<SimpleEdge>(rB, rC, 1e39);
+        Landmarks hugeLandmarks(huge.publishSnapshot(), 1, Landmarks::SELECT_FARTHEST, 1);
+        if (hugeLandmarks.findShortestPath(rA, rC).size() != 2 || hugeLandmarks.findShortestPath(rC, rA).size() != 2) {
+            std::cout << "No path with huge weights!" << std::endl;
+            return;
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
+    /* TEST: Overlay queries find paths as short as Dijkstra's, also after a customization. */
+    void testOverlay()
+    {
+        std::cout << "testOverlay: ";
+
+        Graph h;
+        std::vector<Node*> nodes = makeGrid(h, 30);
+        // a one-way edge and an isolated node
+        h.makeEdge<SimpleEdge>(*nodes[5], *nodes[500], 0.5);
+        Node& rIsolated = h.makeNode<Node>("isolated");
+        auto pSnapshot = h.publishSnapshot();
+
+        // the reference for the customization has squared weights
+        Graph hSquared;
+        std::vector<Node*> nodesSquared = makeGrid(hSquared, 30, 2);
+        hSquared.makeEdge<SimpleEdge>(*nodesSquared[5], *nodesSquared[500], 0.25);
+        auto pSquared = hSquared.publishSnapshot();
+
+        try {
+            Overlay invalid(pSnapshot, { 0, 64 }, 1);
+            std::cout << "No exception for an empty cell size!" << std::endl;
+            return;
+        }
+        catch (const Graph::Exception&) {
+        }
+
+        Overlay overlay(pSnapshot, { 16, 64, 256 }, 3);
+        if (overlay.getNumLevels() != 3 || overlay.getNumCells(1) < 900 / 16 || overlay.getNumCells(3) < 4) {
+            std::cout << "Wrong partition!" << std::endl;
+            return;
+        }
+
+        for (int metric = 0; metric < 2; metric++) {
+            if (metric == 1) {
+                overlay.customize([](const Edge& rEdge) { return rEdge.getWeight() * rEdge.getWeight(); }, 3);
+            }
+
+            for (size_t i = 0; i < 40; i++) {
+                size_t src = (i * 97) % nodes.size();
+                size_t dst = (i * 389 + 11) % nodes.size();
+                auto path = overlay.findShortestPath(*nodes[src], *nodes[dst]);
+                auto expected = metric == 0 ? pSnapshot->findShortestPathDijkstra(*nodes[src], *nodes[dst])
+                                            : pSquared->findShortestPathDijkstra(*nodesSquared[src], *nodesSquared[dst]);
+
+                double weight = 0;
+                for (Edge* pEdge : path) weight += metric == 0 ? pEdge->getWeight() : pow(pEdge->getWeight(), 2);
+                if (weight != getPathWeight(expected) || (src != dst && &path.front()->getSrcNode() != nodes[src])) {
+                    std::cout << "Wrong path for metric " << metric << "!" << std::endl;
+                    return;
+                }
+            }
+        }
+
+        if (!overlay.findShortestPath(*nodes[0], rIsolated).empty()) {
+            std::cout << "Found a path to an isolated node!" << std::endl;
+            return;
+        }
+
+        // queries keep running, while the overlay is customized back to the snapshot weights
+        bool isPathMissing = false;
+        std::thread reader([&]() {
+            for (size_t i = 0; i < 20; i++) {
+                isPathMissing = isPathMissing || overlay.findShortestPath(*nodes[i], *nodes[nodes.size() - 1 - i]).empty();
+            }
+        });
+        overlay.customize(Overlay::tMetric(), 2);
+        reader.join();
+
+        // a second profile shares the partition
+        Overlay squared(overlay, [](const Edge& rEdge) { return rEdge.getWeight() * rEdge.getWeight(); }, 2);
+        for (size_t i = 0; i < 20; i++) {
+            size_t src = (i * 97) % nodes.size();
+            size_t dst = (i * 389 + 11) % nodes.size();
+            double weight = 0;
+            for (Edge* pEdge : squared.findShortestPath(*nodes[src], *nodes[dst])) weight += pow(pEdge->getWeight(), 2);
+            if (isPathMissing || squared.m_pPartition != overlay.m_pPartition
+                    || weight != getPathWeight(pSquared->findShortestPathDijkstra(*nodesSquared[src], *nodesSquared[dst]))
+                    || getPathWeight(overlay.findShortestPath(*nodes[src], *nodes[dst]))
+                       != getPathWeight(pSnapshot->findShortestPathDijkstra(*nodes[src], *nodes[dst]))) {
+                std::cout << "Wrong path with a shared partition!" << std::endl;
+                return;
+            }
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
+    /* TEST: The memory report counts the nodes, edges, the snapshot and the retired objects. */
+    void testMemoryUsage()
+    {
+        std::cout << "testMemoryUsage: ";
+
+        // short ids are stored in the node, long ones on the heap
+        Node shortId("a");
+        Node longId(std::string(100, 'a'));
+        if (shortId.getMemoryUsage() != sizeof(Node) || longId.getMemoryUsage() < sizeof(Node) + 101) {
+            std::cout << "Wrong memory usage of the node ids!" << std::endl;
+            return;
+        }
+
+        Graph h;
+        std::vector<Node*> nodes = makeGrid(h, 30);
+        size_t numEdges = h.m_edges.size();
+
+        Graph::tMemoryUsage usage = h.getMemoryUsage();
+        if (usage.edges != numEdges * sizeof(SimpleEdge) || usage.nodes < nodes.size() * sizeof(Node)
+                || usage.adjacency < 3 * numEdges * sizeof(Edge*) || usage.snapshot != 0 || usage.retired != 0) {
+            std::cout << "Wrong memory usage of the graph!" << std::endl;
+            return;
+        }
+
+        // the corner node has four edges
+        auto pSnapshot = h.publishSnapshot();
+        size_t nodeSize = nodes[0]->getMemoryUsage();
+        h.remove(*nodes[0]);
+        usage = h.getMemoryUsage();
+        if (usage.snapshot != pSnapshot->getMemoryUsage()
+                || usage.snapshot < numEdges * (sizeof(GraphSnapshot::tArc) + sizeof(Edge*))
+                || usage.edges != (numEdges - 4) * sizeof(SimpleEdge)
+                || usage.retired != 4 * sizeof(SimpleEdge) + nodeSize
+                || usage.getTotal() != usage.nodes + usage.edges + usage.adjacency + usage.index + usage.snapshot + usage.retired) {
+            std::cout << "Wrong memory usage of the snapshot!" << std::endl;
+            return;
+        }
+
+        // the old snapshot still keeps the objects after newer publishes, until it is released
+        h.publishSnapshot();
+        h.publishSnapshot();
+        if (h.getMemoryUsage().retired != 4 * sizeof(SimpleEdge) + nodeSize) {
+            std::cout << "The retired objects of the old snapshot are not counted!" << std::endl;
+            return;
+        }
+        pSnapshot.reset();
+        h.publishSnapshot();
+        if (h.getMemoryUsage().retired != 0) {
+            std::cout << "The released objects are still counted!" << std::endl;
+            return;
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
+    /* TEST: A compact graph finds paths as short as the snapshot, also without the object graph. */
+    void testCompactGraph()
+    {
+        std::cout << "testCompactGraph: ";
+
+        std::unique_ptr<CompactGraph<float>> pCompact;
+        std::vector<std::pair<size_t, size_t>> queries;
+        std::vector<double> expected;
+        {
+            Graph h;
+            std::vector<Node*> nodes = makeGrid(h, 30);
+            auto pSnapshot = h.publishSnapshot(Graph::ORDER_RCM);
+            pCompact.reset(new CompactGraph<float>(*pSnapshot));
+
+            const GraphSnapshot::tNodes& snapshotNodes = pSnapshot->getNodes();
+            for (size_t i = 0; i < 20; i++) {
+                queries.push_back(std::make_pair((i * 97) % nodes.size(), (i * 389 + 11) % nodes.size()));
+                expected.push_back(getPathWeight(pSnapshot->findShortestPathDijkstra(
+                    *snapshotNodes[queries.back().first], *snapshotNodes[queries.back().second])));
+            }
+        }
+
+        // the graph and the snapshot are gone, the edge ids are the positions in an edge list
+        CompactGraph<float>::tEdges edges;
+        for (size_t u = 0; u < pCompact->getNumNodes(); u++) {
+            for (size_t a = pCompact->m_firstArc[u]; a < pCompact->m_firstArc[u + 1]; a++) {
+                CompactGraph<float>::tEdge edge = { CompactGraph<float>::tIndex(u), pCompact->m_arcs[a].dst, pCompact->m_arcs[a].weight };
+                edges.push_back(edge);
+            }
+        }
+        std::vector<CompactGraph<double>::tEdge> doubleEdges;
+        for (const auto& rEdge : edges) {
+            CompactGraph<double>::tEdge edge = { rEdge.src, rEdge.dst, rEdge.weight };
+            doubleEdges.push_back(edge);
+        }
+        CompactGraph<double> compactDouble(pCompact->getNumNodes(), doubleEdges);
+
+        for (size_t i = 0; i < queries.size(); i++) {
+            double weight = 0;
+            for (auto id : pCompact->findShortestPathDijkstra(queries[i].first, queries[i].second)) weight += edges[id].weight;
+            double doubleWeight = 0;
+            for (auto id : compactDouble.findShortestPathDijkstra(queries[i].first, queries[i].second)) doubleWeight += doubleEdges[id].weight;
+            if (weight != expected[i] || doubleWeight != expected[i]) {
+                std::cout << "Wrong path for query " << i << "!" << std::endl;
+                return;
+            }
+        }
+
+        // 12 bytes per edge and 4 bytes per node with float weights
+        if (pCompact->getMemoryUsage() != sizeof(CompactGraph<float>) + 12 * edges.size() + 4 * (pCompact->getNumNodes() + 1)) {
+            std::cout << "Wrong memory usage!" << std::endl;
+            return;
+        }
+
+        try {
+            CompactGraph<float>::tEdge invalid = { 0, 5, 1 };
+            CompactGraph<float> tooSmall(5, CompactGraph<float>::tEdges(1, invalid));
+            std::cout << "No exception for an invalid node!" << std::endl;
+            return;
+        }
+        catch (const Graph::InvalidNodeException&) {
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
+    /* TEST: The parallel spanning forest equals the one of Kruskal's algorithm for any number of threads. */
+    void testSpanningForest()
+    {
+        std::cout << "testSpanningForest: ";
+
+        Graph h;
+        std::vector<Node*> nodes = makeGrid(h, 30);
+        // a second component with a self loop and parallel edges of equal weight
+        Node& rA = h.makeNode<Node>("a");
+        Node& rB = h.makeNode<Node>("b");
+        Node& rC = h.makeNode<Node>("c");
+        h.makeEdge<SimpleEdge>(rA, rA, 0.5);
+        h.makeBiEdge<SimpleEdge>(rA, rB, 2);
+        h.makeEdge<SimpleEdge>(rB, rC, 3);
+        h.makeEdge<SimpleEdge>(rC, rA, 3);
+        h.makeNode<Node>("isolated");
+
+        // Kruskal's algorithm with the same order of equal weights
+        std::vector<size_t> order(h.m_edges.size());
+        for (size_t e = 0; e < order.size(); e++) order[e] = e;
+        std::stable_sort(order.begin(), order.end(), [&](size_t l, size_t r) {
+            return h.m_edges[l]->getWeight() < h.m_edges[r]->getWeight();
+        });
+
+        std::map<Node*, Node*> parent;
+        auto find = [&](Node* pNode) {
+            while (parent.count(pNode) > 0) pNode = parent[pNode];
+            return pNode;
+        };
+
+        std::set<Edge*> expected;
+        for (size_t e : order) {
+            Node* pSrc = find(&h.m_edges[e]->getSrcNode());
+            Node* pDst = find(&h.m_edges[e]->getDstNode());
+            if (pSrc != pDst) {
+                parent[pSrc] = pDst;
+                expected.insert(h.m_edges[e]);
+            }
+        }
+
+        // a forest of 3 trees
+        if (expected.size() != nodes.size() + 4 - 3) {
+            std::cout << "Wrong reference forest!" << std::endl;
+            return;
+        }
+
+        for (size_t numThreads : { 1, 2, 4, 7 }) {
+            auto forest = h.findMinimumSpanningForest(numThreads);
+            if (std::set<Edge*>(forest.begin(), forest.end()) != expected || forest.size() != expected.size()) {
+                std::cout << "Wrong forest with " << numThreads << " threads!" << std::endl;
+                return;
+            }
+        }
+
+        // a path with alternating weights has fewer active edges than threads in the last rounds
+        Graph path;
+        std::vector<Node*> pathNodes;
+        for (char id = 'a'; id < 'k'; id++) pathNodes.push_back(&path.makeNode<Node>(std::string(1, id)));
+        for (size_t i = 0; i + 1 < pathNodes.size(); i++) {
+            path.makeEdge<SimpleEdge>(*pathNodes[i], *pathNodes[i + 1], i % 2 == 0 ? 2 : 1);
+        }
+        for (size_t numThreads : { 4, 7 }) {
+            if (path.findMinimumSpanningForest(numThreads).size() != pathNodes.size() - 1) {
+                std::cout << "Wrong forest of the path with " << numThreads << " threads!" << std::endl;
+                return;
+            }
+        }
+
+        // an exception of a worker thread reaches the caller, the last edge is read by the last thread
+        path.makeEdge<BrokenEdge>(*pathNodes[0], *pathNodes.back());
+        try {
+            path.findMinimumSpanningForest(4);
+            std::cout << "The exception of the edge was lost!" << std::endl;
+            return;
+        }
+        catch (const Graph::Exception& e) {
+            if (e.what() != "no weight") {
+                std::cout << "Wrong exception: " << e.what() << std::endl;
+                return;
+            }
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
+    /* TEST: Weakly connected components ignore the direction of the edges. */
+    void testConnectedComponents()
+    {
+        std::cout << "testConnectedComponents: ";
+
+        Graph h;
+        std::vector<Node*> nodes = makeGrid(h, 30);
+        Node& rA = h.makeNode<Node>("a");
+        Node& rB = h.makeNode<Node>("b");
+        Node& rC = h.makeNode<Node>("c");
+        h.makeEdge<SimpleEdge>(rA, rB, 1);
+        h.makeEdge<SimpleEdge>(rC, rB, 1);
+        Node& rIsolated = h.makeNode<Node>("isolated");
+
+        for (size_t numThreads : { 1, 3, 8 }) {
+            auto components = h.findConnectedComponents(numThreads);
+            // the grid ids are numbers, so they come first
+            if (components.size() != 3 || components[0].size() != nodes.size()
+                    || components[1] != std::vector<Node*>({ &rA, &rB, &rC })
+                    || components[2] != std::vector<Node*>(1, &rIsolated)) {
+                std::cout << "Wrong components with " << numThreads << " threads!" << std::endl;
+                return;
+            }
+        }
+
+        // removing a column of the grid splits it
+        for (size_t i = 0; i < 30; i++) {
+            h.remove(*nodes[i * 30 + 10]);
+        }
+        if (h.findConnectedComponents(2).size() != 4) {
+            std::cout << "The grid was not split!" << std::endl;
+            return;
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
     void measSearchSpeed() {
         
         std::vector<double> execTimes;
@@ -116,6 +839,101 @@ public:
     }
 
 
+    void measSnapshotOrder() {
+
+        Graph h;
+        std::vector<Node*> nodes = makeGrid(h, 300);
+
+        std::cout << "Routing times (id, bfs, rcm, hilbert): ";
+        for (Graph::NodeOrder order : { Graph::ORDER_ID, Graph::ORDER_BFS, Graph::ORDER_RCM, Graph::ORDER_HILBERT }) {
+            auto pSnapshot = h.publishSnapshot(order);
+            std::cout << getExecutionSpeed([&]() {
+                for (size_t i = 0; i < 10; i++) {
+                    pSnapshot->findShortestPathDijkstra(*nodes[i * 1000], *nodes[nodes.size() - 1 - i * 1000]);
+                }
+            }) << "s, ";
+        }
+        std::cout << std::endl;
+    }
+
+
+    void measLandmarks() {
+
+        Graph h;
+        std::vector<Node*> nodes = makeGrid(h, 300);
+        auto pSnapshot = h.publishSnapshot(Graph::ORDER_RCM);
+
+        std::unique_ptr<Landmarks> pLandmarks;
+        std::cout << "Landmark preprocessing, Dijkstra, ALT: ";
+        std::cout << getExecutionSpeed([&]() {
+            pLandmarks.reset(new Landmarks(pSnapshot, 16));
+        }) << "s, ";
+
+        GraphSnapshot::Workspace workspace;
+        std::cout << getExecutionSpeed([&]() {
+            for (size_t i = 0; i < 10; i++) {
+                pSnapshot->findShortestPathDijkstra(*nodes[i * 1000], *nodes[nodes.size() - 1 - i * 1000], workspace);
+            }
+        }) << "s, ";
+        std::cout << getExecutionSpeed([&]() {
+            for (size_t i = 0; i < 10; i++) {
+                pLandmarks->findShortestPath(*nodes[i * 1000], *nodes[nodes.size() - 1 - i * 1000], workspace);
+            }
+        }) << "s" << std::endl;
+    }
+
+
+    void measOverlay() {
+
+        // on a grid, the separators grow with the square root of the size, so the overlay does
+        // not pay off. The clusters have small separators like road networks.
+        for (int isClustered = 0; isClustered < 2; isClustered++) {
+            Graph h;
+            std::vector<Node*> nodes = isClustered ? makeClusters(h, 16, 16) : makeGrid(h, 256);
+            auto pSnapshot = h.publishSnapshot(Graph::ORDER_RCM);
+            std::vector<size_t> cellSizes = isClustered ? std::vector<size_t>({ 256, 4096 }) : std::vector<size_t>({ 64, 1024 });
+
+            std::cout << "Overlay on " << (isClustered ? "clusters" : "grid")
+                      << " (partition, customization, Dijkstra, overlay queries): ";
+            std::cout << getExecutionSpeed([&]() { Overlay::createPartition(*pSnapshot, cellSizes); }) << "s, ";
+
+            Overlay overlay(pSnapshot, cellSizes);
+            std::cout << getExecutionSpeed([&]() {
+                overlay.customize([](const Edge& rEdge) { return 2 * rEdge.getWeight(); });
+            }) << "s, ";
+
+            GraphSnapshot::Workspace workspace;
+            std::cout << getExecutionSpeed([&]() {
+                for (size_t i = 0; i < 10; i++) {
+                    pSnapshot->findShortestPathDijkstra(*nodes[i * 1000], *nodes[nodes.size() - 1 - i * 1000], workspace);
+                }
+            }) << "s, ";
+            std::cout << getExecutionSpeed([&]() {
+                for (size_t i = 0; i < 10; i++) {
+                    overlay.findShortestPath(*nodes[i * 1000], *nodes[nodes.size() - 1 - i * 1000], workspace);
+                }
+            }) << "s" << std::endl;
+        }
+    }
+
+
+    void measSpanningForest() {
+
+        Graph h;
+        std::vector<Node*> nodes = makeGrid(h, 300);
+        size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+        std::cout << "Spanning forest, components (1, " << numThreads << " threads): ";
+        for (size_t threads : { size_t(1), numThreads }) {
+            std::cout << getExecutionSpeed([&]() { h.findMinimumSpanningForest(threads); }) << "s, ";
+        }
+        for (size_t threads : { size_t(1), numThreads }) {
+            std::cout << getExecutionSpeed([&]() { h.findConnectedComponents(threads); }) << "s, ";
+        }
+        std::cout << std::endl;
+    }
+
+
 private:
 
     Graph g;
@@ -131,9 +949,22 @@ int main()
     std::cout << "---- Test results: --------------" << std::endl;
     gt.testNodeOrder();
     gt.testRouting();
+    gt.testSnapshot();
+    gt.testSnapshotOrder();
+    gt.testQueryExecutor();
+    gt.testLandmarks();
+    gt.testOverlay();
+    gt.testMemoryUsage();
+    gt.testCompactGraph();
+    gt.testSpanningForest();
+    gt.testConnectedComponents();
 
     std::cout << "---- Time measurements: ---------" << std::endl;
     gt.measSearchSpeed();
+    gt.measSnapshotOrder();
+    gt.measLandmarks();
+    gt.measOverlay();
+    gt.measSpanningForest();
 
     return 0;
 }